@@ -1,4 +1,6 @@
 #pragma once
+#include <cstdint>
+
 enum class ActionID
 {
 	MoveLeft,
@@ -8,4 +10,7 @@ enum class ActionID
 	Fire,
 	LaunchMissile,
 	ActionCount
-};
\ No newline at end of file
+};
+
+//One bit per action, 1 << ActionID; the per-tick input of one player
+typedef std::uint8_t ActionBits;
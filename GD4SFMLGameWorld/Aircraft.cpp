@@ -5,6 +5,8 @@
 #include "Pickup.hpp"
 #include "CommandQueue.hpp"
 #include "SoundNode.hpp"
+#include "BulletSystem.hpp"
+#include "SpriteBatch.hpp"
 
 #include <SFML/Graphics/RenderTarget.hpp>
 #include "SFML/Graphics/RenderStates.hpp"
@@ -13,6 +15,7 @@
 #include "ProjectileID.hpp"
 #include "PickupID.hpp"
 
+#include <cassert>
 #include <cmath>
 
 namespace
@@ -36,11 +39,13 @@ TextureID toTextureID(AircraftID type)
 	return TextureID::Player;
 }
 
-Aircraft::Aircraft(AircraftID type, const TextureHolder& textures, const FontHolder& fonts)
-	: Entity(Table[static_cast<int>(type)].hitpoints)
+Aircraft::Aircraft(AircraftID type, const TextureHolder& textures, const FontHolder* fonts, ProjectilePool& projectiles, IdentifierSequence& identifiers)
+	: Entity(Table[static_cast<int>(type)].hitpoints, identifiers)
 	, mType(type)
 	, mSprite(textures.get(Table[static_cast<int>(type)].texture), Table[static_cast<int>(type)].textureRect)
 	, mExplosion(textures.get(TextureID::Explosion))
+	, mProjectilePool(projectiles)
+	, mIdentifiers(identifiers)
 	, mFireCommand()
 	, mMissileCommand()
 	, mFireCountdown(sf::Time::Zero)
@@ -58,6 +63,8 @@ Aircraft::Aircraft(AircraftID type, const TextureHolder& textures, const FontHol
 	, mDirectionIndex(0)
 	, mHealthDisplay(nullptr)
 	, mMissileDisplay(nullptr)
+	, mDisplayedHitpoints(-1)
+	, mDisplayedMissileAmmo(-1)
 {
 	mExplosion.setFrameSize(sf::Vector2i(256, 256));
 	mExplosion.setNumFrames(16);
@@ -66,11 +73,11 @@ Aircraft::Aircraft(AircraftID type, const TextureHolder& textures, const FontHol
 	centreOrigin(mSprite);
 	centreOrigin(mExplosion);
 
-	mFireCommand.category = static_cast<int>(CategoryID::SceneAirLayer);
-	mFireCommand.action = [this, &textures](SceneNode& node, sf::Time)
+	mFireCommand.category = static_cast<int>(CategoryID::BulletSystem);
+	mFireCommand.action = derivedAction<BulletSystem>([this](BulletSystem& bullets, sf::Time)
 	{
-		createBullets(node, textures);
-	};
+		createBullets(bullets);
+	});
 
 	mMissileCommand.category = static_cast<int>(CategoryID::SceneAirLayer);
 	mMissileCommand.action = [this, &textures](SceneNode& node, sf::Time)
@@ -84,24 +91,27 @@ Aircraft::Aircraft(AircraftID type, const TextureHolder& textures, const FontHol
 		createPickup(node, textures);
 	};
 
-	std::unique_ptr<TextNode> healthDisplay(new TextNode(fonts, ""));
-	mHealthDisplay = healthDisplay.get();
-	attachChild(std::move(healthDisplay));
-
-	if (getCategory() == (static_cast<int>(CategoryID::PlayerAircraft)))
+	if (fonts)
 	{
-		std::unique_ptr<TextNode> missileDisplay(new TextNode(fonts, ""));
-		missileDisplay->setPosition(0, 70);
-		mMissileDisplay = missileDisplay.get();
-		attachChild(std::move(missileDisplay));
-	}
+		std::unique_ptr<TextNode> healthDisplay(new TextNode(*fonts, ""));
+		mHealthDisplay = healthDisplay.get();
+		attachChild(std::move(healthDisplay));
 
-	if (getCategory() == (static_cast<int>(CategoryID::Player2Aircraft)))
-	{
-		std::unique_ptr<TextNode> missileDisplay(new TextNode(fonts, ""));
-		missileDisplay->setPosition(0, 70);
-		mMissileDisplay = missileDisplay.get();
-		attachChild(std::move(missileDisplay));
+		if (getCategory() == (static_cast<int>(CategoryID::PlayerAircraft)))
+		{
+			std::unique_ptr<TextNode> missileDisplay(new TextNode(*fonts, ""));
+			missileDisplay->setPosition(0, 70);
+			mMissileDisplay = missileDisplay.get();
+			attachChild(std::move(missileDisplay));
+		}
+
+		if (getCategory() == (static_cast<int>(CategoryID::Player2Aircraft)))
+		{
+			std::unique_ptr<TextNode> missileDisplay(new TextNode(*fonts, ""));
+			missileDisplay->setPosition(0, 70);
+			mMissileDisplay = missileDisplay.get();
+			attachChild(std::move(missileDisplay));
+		}
 	}
 	updateTexts();
 }
@@ -115,6 +125,20 @@ void Aircraft::drawCurrent(sf::RenderTarget& target, sf::RenderStates states) co
 		target.draw(mSprite, states);
 }
 
+void Aircraft::batchCurrent(SpriteBatch& batch, sf::RenderStates states) const
+{
+	// The explosion's current frame is batched like a sprite, so a recorded frame needs nothing from the animation
+	if (isDestroyed() && mShowExplosion)
+	{
+		states.transform *= mExplosion.getTransform();
+		batch.draw(mExplosion.getSprite(), states);
+	}
+	else
+	{
+		batch.draw(mSprite, states);
+	}
+}
+
 void Aircraft::updateCurrent(sf::Time dt, CommandQueue& commands)
 {
 	// Entity has been destroyed: Possibly drop pickup, mark for removal
@@ -126,7 +150,8 @@ void Aircraft::updateCurrent(sf::Time dt, CommandQueue& commands)
 		//Play explosion sound
 		if (!mPlayedExplosionSound)
 		{
-			SoundEffectID soundEffect = (randomInt(2) == 0) ? SoundEffectID::Explosion1 : SoundEffectID::Explosion2;
+			// Picked by identifier rather than the shared random engine, which entities updating on several threads cannot share
+			SoundEffectID soundEffect = (getIdentifier() % 2 == 0) ? SoundEffectID::Explosion1 : SoundEffectID::Explosion2;
 			playerLocalSound(commands, soundEffect);
 
 			mPlayedExplosionSound = true;
@@ -167,6 +192,11 @@ bool Aircraft::isMarkedForRemoval() const
 	return isDestroyed() && (mExplosion.isFinished() || !mShowExplosion);
 }
 
+AircraftID Aircraft::getType() const
+{
+	return mType;
+}
+
 bool Aircraft::isAlliedPlayer1() const
 {
 	return mType == AircraftID::Player;
@@ -203,6 +233,28 @@ void Aircraft::collectMissiles(unsigned int count)
 	mMissileAmmo += count;
 }
 
+int Aircraft::getFireRateLevel() const
+{
+	return mFireRateLevel;
+}
+
+int Aircraft::getSpreadLevel() const
+{
+	return mSpreadLevel;
+}
+
+int Aircraft::getMissileAmmo() const
+{
+	return mMissileAmmo;
+}
+
+void Aircraft::setWeaponState(int fireRateLevel, int spreadLevel, int missileAmmo)
+{
+	mFireRateLevel = fireRateLevel;
+	mSpreadLevel = spreadLevel;
+	mMissileAmmo = missileAmmo;
+}
+
 void Aircraft::playerLocalSound(CommandQueue& commands, SoundEffectID effect)
 {
 	sf::Vector2f worldPosition = getWorldPosition();
@@ -214,7 +266,42 @@ void Aircraft::playerLocalSound(CommandQueue& commands, SoundEffectID effect)
 	{
 		node.playSound(effect, worldPosition);
 	});
-	commands.push(command);
+	commands.push(std::move(command));
+}
+
+void Aircraft::saveState(State& state) const
+{
+	Entity::saveState(state);
+	state.type = mType;
+	state.isFiring = mIsFiring;
+	state.isLaunchingMissile = mIsLaunchingMissile;
+	state.fireRateLevel = mFireRateLevel;
+	state.fireCountdown = mFireCountdown;
+	state.spreadLevel = mSpreadLevel;
+	state.missileAmmo = mMissileAmmo;
+	state.travelledDistance = mTravelledDistance;
+	state.directionIndex = mDirectionIndex;
+	state.explosionProgress = mExplosion.getProgress();
+	state.playedExplosionSound = mPlayedExplosionSound;
+}
+
+void Aircraft::restoreState(const State& state)
+{
+	assert(state.type == mType);
+
+	Entity::restoreState(state);
+	mIsFiring = state.isFiring;
+	mIsLaunchingMissile = state.isLaunchingMissile;
+	mFireRateLevel = state.fireRateLevel;
+	mFireCountdown = state.fireCountdown;
+	mSpreadLevel = state.spreadLevel;
+	mMissileAmmo = state.missileAmmo;
+	mTravelledDistance = state.travelledDistance;
+	mDirectionIndex = state.directionIndex;
+	mExplosion.setProgress(state.explosionProgress);
+	mPlayedExplosionSound = state.playedExplosionSound;
+
+	updateTexts();
 }
 
 void Aircraft::fire()
@@ -276,7 +363,7 @@ void Aircraft::checkProjectileLaunch(sf::Time dt, CommandQueue& commands)
 	if (mIsFiring && mFireCountdown <= sf::Time::Zero)
 	{
 		// Interval expired: We can fire a new bullet
-		commands.push(mFireCommand);
+		commands.push(forwardCommand(mFireCommand));
 		playerLocalSound(commands, isAlliedPlayer1() || isAlliedPlayer2() ? SoundEffectID::AlliedLasers : SoundEffectID::EnemyGunfire);
 		
 		mFireCountdown += Table[static_cast<int>(mType)].fireInterval / (mFireRateLevel + 1.f);
@@ -292,31 +379,35 @@ void Aircraft::checkProjectileLaunch(sf::Time dt, CommandQueue& commands)
 	// Check for missile launch
 	if (mIsLaunchingMissile)
 	{
-		commands.push(mMissileCommand);
+		commands.push(forwardCommand(mMissileCommand));
 		playerLocalSound(commands, SoundEffectID::LaunchMissile);
 		mIsLaunchingMissile = false;
 	}
 }
 
-void Aircraft::createBullets(SceneNode& node, const TextureHolder& textures) 
+void Aircraft::createBullets(BulletSystem& bullets)
 {
-	
+	// Bullets live in the bullet system's arrays rather than as scene nodes
 	ProjectileID type = isAlliedPlayer1() || isAlliedPlayer2() ? ProjectileID::AlliedBullet : ProjectileID::EnemyBullet;
+	sf::Vector2f position = getWorldPosition();
+	float width = mSprite.getGlobalBounds().width;
+	sf::Vector2f direction(1.f, 0.f);
+
 	switch (mSpreadLevel)
 	{
 	case 1:
-		createProjectile(node, type, 0.0f, 0.01f, textures);
+		bullets.spawn(type, position + sf::Vector2f(0.0f * width, 0.01f), direction);
 		break;
 
 	case 2:
-		createProjectile(node, type, -0.33f, 0.01f, textures);
-		createProjectile(node, type, +0.33f, 0.01f, textures);
+		bullets.spawn(type, position + sf::Vector2f(-0.33f * width, 0.01f), direction);
+		bullets.spawn(type, position + sf::Vector2f(+0.33f * width, 0.01f), direction);
 		break;
 
 	case 3:
-		createProjectile(node, type, -0.5f, 0.01f, textures);
-		createProjectile(node, type, 0.0f, 0.01f, textures);
-		createProjectile(node, type, +0.5f, 0.01f, textures);
+		bullets.spawn(type, position + sf::Vector2f(-0.5f * width, 0.01f), direction);
+		bullets.spawn(type, position + sf::Vector2f(0.0f * width, 0.01f), direction);
+		bullets.spawn(type, position + sf::Vector2f(+0.5f * width, 0.01f), direction);
 		break;
 	}
 	//Eoghan
@@ -335,7 +426,7 @@ void Aircraft::createBullets(SceneNode& node, const TextureHolder& textures)
 
 void Aircraft::createProjectile(SceneNode& node, ProjectileID type, float xOffset, float yOffset, const TextureHolder& textures) const
 {
-	std::unique_ptr<Projectile> projectile(new Projectile(type, textures));
+	std::unique_ptr<Projectile> projectile(new (mProjectilePool) Projectile(type, textures, mIdentifiers));
 
 	sf::Vector2f offset(xOffset * mSprite.getGlobalBounds().width, 0.01f);
 	sf::Vector2f velocity(projectile->getMaxSpeed(), 0);
@@ -352,7 +443,7 @@ void Aircraft::createPickup(SceneNode& node, const TextureHolder& textures) cons
 {
 	auto type = static_cast<PickupID>(randomInt(static_cast<int>(PickupID::TypeCount)));
 
-	std::unique_ptr<Pickup> pickup(new Pickup(type, textures));
+	std::unique_ptr<Pickup> pickup(new Pickup(type, textures, mIdentifiers));
 	pickup->setPosition(getWorldPosition());
 	pickup->setVelocity(0.f, 1.f);
 	node.attachChild(std::move(pickup));
@@ -360,12 +451,23 @@ void Aircraft::createPickup(SceneNode& node, const TextureHolder& textures) cons
 
 void Aircraft::updateTexts()
 {
-	mHealthDisplay->setString(toString(getHitpoints()) + " HP");
-	mHealthDisplay->setPosition(0.f, 50.f);
-	mHealthDisplay->setRotation(-getRotation());
+	if (mHealthDisplay)
+	{
+		mHealthDisplay->setPosition(0.f, 50.f);
+		mHealthDisplay->setRotation(-getRotation());
+	}
+
+	// Formatting the strings is the costly part, and the numbers rarely change from one tick to the next
+	if (mHealthDisplay && mDisplayedHitpoints != getHitpoints())
+	{
+		mHealthDisplay->setString(toString(getHitpoints()) + " HP");
+		mDisplayedHitpoints = getHitpoints();
+	}
 
-	if (mMissileDisplay)
+	if (mMissileDisplay && mDisplayedMissileAmmo != mMissileAmmo)
 	{
+		mDisplayedMissileAmmo = mMissileAmmo;
+
 		if (mMissileAmmo == 0)
 			mMissileDisplay->setString("");
 		else
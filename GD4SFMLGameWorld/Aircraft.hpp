@@ -7,13 +7,36 @@
 #include "Projectile.hpp"
 #include "Animation.hpp"
 
+class BulletSystem;
+class ProjectilePool;
+class IdentifierSequence;
+
 class Aircraft : public Entity
 {
 public:
-	Aircraft(AircraftID type, const TextureHolder& textures, const FontHolder& fonts);
+	struct State : Entity::State
+	{
+		AircraftID type;
+		bool isFiring;
+		bool isLaunchingMissile;
+		int fireRateLevel;
+		sf::Time fireCountdown;
+		int spreadLevel;
+		int missileAmmo;
+		float travelledDistance;
+		std::size_t directionIndex;
+		sf::Time explosionProgress;
+		bool playedExplosionSound;
+	};
+
+public:
+	//Without fonts (headless worlds) the aircraft has no health or missile display
+	//Projectiles it launches come from projectiles, the pool of its World, and are named from identifiers, its World's sequence
+	Aircraft(AircraftID type, const TextureHolder& textures, const FontHolder* fonts, ProjectilePool& projectiles, IdentifierSequence& identifiers);
 	virtual unsigned int getCategory() const;
 	virtual sf::FloatRect getBoundingRect() const;
 	virtual bool isMarkedForRemoval() const;
+	AircraftID getType() const;
 
 	float getMaxSpeed() const;
 	void fire();
@@ -25,17 +48,27 @@ public:
 	void increaseSpread();
 	void collectMissiles(unsigned int count);
 
+	int getFireRateLevel() const;
+	int getSpreadLevel() const;
+	int getMissileAmmo() const;
+	//Replicas and restored saves take these from a snapshot instead of collecting pickups
+	void setWeaponState(int fireRateLevel, int spreadLevel, int missileAmmo);
+
 	void playerLocalSound(CommandQueue& command, SoundEffectID effect);
 
+	void saveState(State& state) const;
+	void restoreState(const State& state);
+
 private:
 	virtual void drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const;
+	virtual void batchCurrent(SpriteBatch& batch, sf::RenderStates states) const;
 	virtual void updateCurrent(sf::Time dt, CommandQueue& commands);
 	void updateMovementPattern(sf::Time dt);
 	void updateTexts();
 
 	void checkProjectileLaunch(sf::Time dt, CommandQueue& commands);
 
-	void createBullets(SceneNode& node, const TextureHolder& textures);
+	void createBullets(BulletSystem& bullets);
 	void createProjectile(SceneNode& node, ProjectileID type, float xOffset, float yOffset, const TextureHolder& textures) const;
 
 	void createPickup(SceneNode& node, const TextureHolder& textures) const;
@@ -46,8 +79,12 @@ private:
 	AircraftID mType;
 	sf::Sprite mSprite;
 	Animation mExplosion;
+	ProjectilePool& mProjectilePool;
+	IdentifierSequence& mIdentifiers;
 	TextNode* mHealthDisplay;
 	TextNode* mMissileDisplay;
+	int mDisplayedHitpoints;
+	int mDisplayedMissileAmmo;
 
 	bool mIsFiring;
 	bool mIsLaunchingMissile;
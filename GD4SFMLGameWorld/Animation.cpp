@@ -86,6 +86,24 @@ bool Animation::isFinished() const
 	return mCurrentFrame >= mNumFrames;
 }
 
+sf::Time Animation::getProgress() const
+{
+	return mDuration / static_cast<float>(mNumFrames) * static_cast<sf::Int64>(mCurrentFrame) + mElapsedTime;
+}
+
+void Animation::setProgress(sf::Time progress)
+{
+	// Replaying from the first frame in one step ends on the same frame and texture rect as the original steps
+	mCurrentFrame = 0;
+	mElapsedTime = sf::Time::Zero;
+	update(progress);
+}
+
+const sf::Sprite& Animation::getSprite() const
+{
+	return mSprite;
+}
+
 sf::FloatRect Animation::getLocalBounds() const
 {
 	return sf::FloatRect(getOrigin(), static_cast<sf::Vector2f>(getFrameSize()));
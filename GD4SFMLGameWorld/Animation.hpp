@@ -28,6 +28,13 @@ public:
 	void 					restart();
 	bool 					isFinished() const;
 
+	//Time played since the start, for saving and restoring the animation with its owner
+	sf::Time 				getProgress() const;
+	void 					setProgress(sf::Time progress);
+
+	//Current frame, for batching the animation like any other sprite; the animation's own transform is not applied
+	const sf::Sprite& 		getSprite() const;
+
 	sf::FloatRect 			getLocalBounds() const;
 	sf::FloatRect 			getGlobalBounds() const;
 
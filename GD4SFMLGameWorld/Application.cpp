@@ -3,13 +3,25 @@
 #include "TitleState.hpp"
 #include "MenuState.hpp"
 #include "GameState.hpp"
+#include "NetworkGameState.hpp"
 #include "PauseState.hpp"
 #include "SettingsState.hpp"
 #include "GameOverState.hpp"
 
+#include <algorithm>
+
 const sf::Time Application::TimePerFrame = sf::seconds(1.f / 60.f);
 
-Application::Application()
+namespace
+{
+	// Longer frames are stalls (opening music, dragging the window); the time beyond this is not caught up
+	const sf::Time MaxFrameTime = sf::seconds(0.25f);
+	// Real time a frame may spend catching up, so frames keep coming while ticks are expensive
+	const sf::Time MaxUpdateTime = sf::seconds(1.f / 30.f);
+	const float MinTimeScale = 0.25f;
+}
+
+Application::Application(bool renderThread)
 	: mWindow(sf::VideoMode(1024, 768), "Game Play", sf::Style::Close)
 	, mTextures()
 	, mFonts()
@@ -17,10 +29,17 @@ Application::Application()
 	, mPlayer2()
 	, mMusic()
 	, mSoundPlayer()
-	, mStateStack(State::Context(mWindow, mTextures, mFonts, mPlayer, mPlayer2, mMusic, mSoundPlayer))
+	, mProfiler()
+	, mStateStack(State::Context(mWindow, mTextures, mFonts, mPlayer, mPlayer2, mMusic, mSoundPlayer, mProfiler, renderThread))
 	, mStatisticText()
 	, mStatisticsUpdateTime()
 	, mStatisticsNumFrames(0)
+	, mMaxTicksPerFrame(DefaultMaxTicksPerFrame)
+	, mTimeDilation(true)
+	, mTimeScale(1.f)
+	, mTickCost()
+	, mDroppedTime()
+	, mSlowedTime()
 {
 	mWindow.setKeyRepeatEnabled(false);
 
@@ -29,7 +48,7 @@ Application::Application()
 	mTextures.load(TextureID::Buttons, "Media/Textures/Buttons.png");
 	mStatisticText.setFont(mFonts.get(FontID::Main));
 	mStatisticText.setPosition(5.f, 5.f);
-	mStatisticText.setCharacterSize(20);
+	mStatisticText.setCharacterSize(14);
 
 	registerStates();
 	mStateStack.pushState(StateID::Title);
@@ -42,12 +61,34 @@ void Application::run()
 	while (mWindow.isOpen())
 	{
 		sf::Time elapsedTime = clock.restart();
-		timeSinceLastUpdate += elapsedTime;
-		while (timeSinceLastUpdate > TimePerFrame)
+
+		//A network game keeps the server's pace: no time is capped, slowed or dropped, and a backlog is
+		//worked off at the tick budget over the next frames
+		bool realTime = mStateStack.needsRealTime();
+		if (realTime)
+			mTimeScale = 1.f;
+
+		//Without a cap, a stall would be followed by a burst of ticks that makes the next frame later still
+		sf::Time frameTime = realTime ? elapsedTime : std::min(elapsedTime, MaxFrameTime);
+		mDroppedTime += elapsedTime - frameTime;
+
+		timeSinceLastUpdate += frameTime * mTimeScale;
+		mSlowedTime += frameTime * (1.f - mTimeScale);
+
+		std::size_t budget = getTickBudget();
+		std::size_t ticks = 0;
+		while (timeSinceLastUpdate > TimePerFrame && ticks < budget)
 		{
 			timeSinceLastUpdate -= TimePerFrame;
+			++ticks;
 			processInput();
-			update(TimePerFrame);
+
+			sf::Clock tickClock;
+			{
+				Profiler::Scope scope(&mProfiler, ProfileSectionID::Update);
+				update(TimePerFrame);
+			}
+			mTickCost = mTickCost * 0.9f + tickClock.getElapsedTime() * 0.1f;
 
 			//Check if the statestack is empty
 			if (mStateStack.isEmpty())
@@ -55,11 +96,71 @@ void Application::run()
 				mWindow.close();
 			}
 		}
+
+		//Ticks the budget had no room for are dropped, all but the fraction the picture is interpolated by
+		bool behind = timeSinceLastUpdate > TimePerFrame;
+		if (behind && !realTime)
+		{
+			sf::Int64 backlog = timeSinceLastUpdate.asMicroseconds() / TimePerFrame.asMicroseconds();
+			timeSinceLastUpdate -= TimePerFrame * backlog;
+			mDroppedTime += TimePerFrame * backlog;
+		}
+
+		if (!realTime)
+			adaptTimeScale(behind);
+		updateTickStatistics(ticks, budget);
 		updateStatistics(elapsedTime);
-		draw();
+
+		//The picture is drawn between the last two ticks, by how far the clock is into the next one
+		draw(std::min(1.f, timeSinceLastUpdate / TimePerFrame));
+
+		mProfiler.addSample(ProfileSectionID::Frame, elapsedTime);
+		mProfiler.endFrame();
 	}
 }
 
+void Application::setMaxTicksPerFrame(std::size_t ticks)
+{
+	mMaxTicksPerFrame = std::max<std::size_t>(ticks, 1);
+}
+
+void Application::setTimeDilation(bool enabled)
+{
+	mTimeDilation = enabled;
+	if (!enabled)
+		mTimeScale = 1.f;
+}
+
+std::size_t Application::getTickBudget() const
+{
+	if (mTickCost.asMicroseconds() <= 0)
+		return mMaxTicksPerFrame;
+
+	sf::Int64 affordable = MaxUpdateTime.asMicroseconds() / mTickCost.asMicroseconds();
+	return static_cast<std::size_t>(std::max<sf::Int64>(1, std::min<sf::Int64>(affordable, mMaxTicksPerFrame)));
+}
+
+void Application::adaptTimeScale(bool behind)
+{
+	if (!mTimeDilation)
+		return;
+
+	// Slow down quickly while ticks are dropped, and creep back to real time once they are not
+	if (behind)
+		mTimeScale = std::max(MinTimeScale, mTimeScale * 0.9f);
+	else
+		mTimeScale = std::min(1.f, mTimeScale + 0.01f);
+}
+
+void Application::updateTickStatistics(std::size_t ticks, std::size_t budget)
+{
+	mProfiler.setCounter("Ticks this frame", ticks);
+	mProfiler.setCounter("Tick budget", budget);
+	mProfiler.setCounter("Ticks dropped", static_cast<std::size_t>(mDroppedTime.asMicroseconds() / TimePerFrame.asMicroseconds()));
+	mProfiler.setCounter("Ticks slowed", static_cast<std::size_t>(mSlowedTime.asMicroseconds() / TimePerFrame.asMicroseconds()));
+	mProfiler.setCounter("Time scale (%)", static_cast<std::size_t>(mTimeScale * 100.f + 0.5f));
+}
+
 void Application::processInput()
 {
 	sf::Event event;
@@ -71,6 +172,13 @@ void Application::processInput()
 		{
 			mWindow.close();
 		}
+
+		//Dump the profiler window: per-frame rows as CSV, rolling statistics as JSON
+		if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F12)
+		{
+			mProfiler.saveToCsv("Profile.csv");
+			mProfiler.saveToJson("Profile.json");
+		}
 	}
 }
 
@@ -79,13 +187,15 @@ void Application::update(sf::Time dt)
 	mStateStack.update(dt);
 }
 
-void Application::draw()
+void Application::draw(float alpha)
 {
 	mWindow.clear();
-	mStateStack.draw();
+	mStateStack.draw(alpha);
 
 	mWindow.setView(mWindow.getDefaultView());
 	mWindow.draw(mStatisticText);
+
+	Profiler::Scope scope(&mProfiler, ProfileSectionID::Display);
 	mWindow.display();
 }
 
@@ -96,8 +206,7 @@ void Application::updateStatistics(sf::Time dt)
 
 	if (mStatisticsUpdateTime >= sf::seconds(1.0f))
 	{
-		mStatisticText.setString("Frames/Second = " + toString(mStatisticsNumFrames) + "\n" +
-			"Time/Update = " + toString(mStatisticsUpdateTime.asMicroseconds() / mStatisticsNumFrames) + "us");
+		mStatisticText.setString("Frames/Second = " + toString(mStatisticsNumFrames) + "\n" + mProfiler.getOverlayText());
 
 		mStatisticsUpdateTime -= sf::seconds(1.0f);
 		mStatisticsNumFrames = 0;
@@ -109,6 +218,7 @@ void Application::registerStates()
 	mStateStack.registerState<TitleState>(StateID::Title);
 	mStateStack.registerState<MenuState>(StateID::Menu);
 	mStateStack.registerState<GameState>(StateID::Game);
+	mStateStack.registerState<NetworkGameState>(StateID::NetworkGame);
 	mStateStack.registerState<PauseState>(StateID::Pause);
 	mStateStack.registerState<SettingState>(StateID::Settings);
 	mStateStack.registerState<GameOverState>(StateID::GameOver);
@@ -5,6 +5,7 @@
 #include "Player2.hpp"
 #include "StateStack.hpp"
 #include "MusicPlayer.hpp"
+#include "Profiler.hpp"
 
 #include <SFML/System/Time.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
@@ -13,20 +14,31 @@
 class Application
 {
 public:
-	Application();
+	//With renderThread, missions draw on a separate thread and simulate while the previous frame is drawn
+	explicit Application(bool renderThread = false);
 	void run();
 
+	//Catch-up after a slow frame runs at most this many ticks, fewer when ticks are expensive; the rest is dropped
+	void setMaxTicksPerFrame(std::size_t ticks);
+	//When ticks keep being dropped, slow the game clock down instead, so the game runs evenly slower
+	void setTimeDilation(bool enabled);
+
+	static const sf::Time TimePerFrame;
+	static const std::size_t DefaultMaxTicksPerFrame = 5;
+
 private:
 	void processInput();
 	void update(sf::Time dt);
-	void draw();
+	void draw(float alpha);
+
+	std::size_t getTickBudget() const;
+	void adaptTimeScale(bool behind);
+	void updateTickStatistics(std::size_t ticks, std::size_t budget);
 
 	void updateStatistics(sf::Time dt);
 	void registerStates();
 
 private:
-	static const sf::Time TimePerFrame;
-
 	sf::RenderWindow mWindow;
 	TextureHolder mTextures;
 	FontHolder mFonts;
@@ -34,6 +46,7 @@ private:
 	Player2 mPlayer2;
 	MusicPlayer mMusic;
 	SoundPlayer mSoundPlayer;
+	Profiler mProfiler;
 
 	StateStack mStateStack;
 
@@ -41,4 +54,13 @@ private:
 	sf::Time mStatisticsUpdateTime;
 	std::size_t mStatisticsNumFrames;
 
+	std::size_t mMaxTicksPerFrame;
+	bool mTimeDilation;
+	float mTimeScale;
+	// Smoothed real time of one update, which decides how many fit in a frame
+	sf::Time mTickCost;
+	// Game time given up to stalls and dropped ticks, and to dilation
+	sf::Time mDroppedTime;
+	sf::Time mSlowedTime;
+
 };
\ No newline at end of file
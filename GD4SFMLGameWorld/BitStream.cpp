@@ -0,0 +1,140 @@
+#include "BitStream.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+	const unsigned int CompactWidths[4] = { 4, 8, 16, 32 };
+
+	// Zigzag: 0, -1, 1, -2, ... map to 0, 1, 2, 3, ..., so small magnitudes of either sign stay small
+	sf::Uint32 toZigzag(sf::Int32 value)
+	{
+		return (static_cast<sf::Uint32>(value) << 1) ^ static_cast<sf::Uint32>(value >> 31);
+	}
+
+	sf::Int32 fromZigzag(sf::Uint32 value)
+	{
+		return static_cast<sf::Int32>(value >> 1) ^ -static_cast<sf::Int32>(value & 1);
+	}
+}
+
+BitWriter::BitWriter(std::vector<sf::Uint8>& buffer)
+	: mBuffer(&buffer)
+	, mBitCount(buffer.size() * 8)
+{
+}
+
+BitWriter::BitWriter()
+	: mBuffer(nullptr)
+	, mBitCount(0)
+{
+}
+
+void BitWriter::write(sf::Uint32 value, unsigned int bits)
+{
+	assert(bits <= 32);
+	assert(bits == 32 || value < (sf::Uint64(1) << bits));
+
+	if (!mBuffer)
+	{
+		mBitCount += bits;
+		return;
+	}
+
+	while (bits > 0)
+	{
+		std::size_t bitOffset = mBitCount % 8;
+		if (bitOffset == 0)
+			mBuffer->push_back(0);
+
+		// Fill the rest of the current byte in one go
+		unsigned int chunk = std::min<unsigned int>(bits, 8 - static_cast<unsigned int>(bitOffset));
+		sf::Uint32 mask = (1u << chunk) - 1;
+		mBuffer->back() |= static_cast<sf::Uint8>((value & mask) << bitOffset);
+
+		value = chunk < 32 ? value >> chunk : 0;
+		bits -= chunk;
+		mBitCount += chunk;
+	}
+}
+
+void BitWriter::writeBool(bool value)
+{
+	write(value ? 1 : 0, 1);
+}
+
+void BitWriter::writeCompact(sf::Uint32 value)
+{
+	sf::Uint32 widthIndex = 0;
+	while (widthIndex < 3 && value >= (sf::Uint64(1) << CompactWidths[widthIndex]))
+		++widthIndex;
+
+	write(widthIndex, 2);
+	write(value, CompactWidths[widthIndex]);
+}
+
+void BitWriter::writeCompactSigned(sf::Int32 value)
+{
+	writeCompact(toZigzag(value));
+}
+
+std::size_t BitWriter::getBitCount() const
+{
+	return mBitCount;
+}
+
+BitReader::BitReader(const sf::Uint8* data, std::size_t size)
+	: mData(data)
+	, mSize(size)
+	, mBitPosition(0)
+	, mValid(true)
+{
+}
+
+sf::Uint32 BitReader::read(unsigned int bits)
+{
+	assert(bits <= 32);
+
+	if (mBitPosition + bits > mSize * 8)
+	{
+		mValid = false;
+		return 0;
+	}
+
+	sf::Uint32 value = 0;
+	unsigned int shift = 0;
+	while (bits > 0)
+	{
+		std::size_t bitOffset = mBitPosition % 8;
+		unsigned int chunk = std::min<unsigned int>(bits, 8 - static_cast<unsigned int>(bitOffset));
+		sf::Uint32 mask = (1u << chunk) - 1;
+		value |= ((mData[mBitPosition / 8] >> bitOffset) & mask) << shift;
+
+		shift += chunk;
+		bits -= chunk;
+		mBitPosition += chunk;
+	}
+
+	return value;
+}
+
+bool BitReader::readBool()
+{
+	return read(1) != 0;
+}
+
+sf::Uint32 BitReader::readCompact()
+{
+	return read(CompactWidths[read(2)]);
+}
+
+sf::Int32 BitReader::readCompactSigned()
+{
+	return fromZigzag(readCompact());
+}
+
+bool BitReader::isValid() const
+{
+	return mValid;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <SFML/Config.hpp>
+
+#include <cstddef>
+#include <vector>
+
+//Writes values of any bit width back to back, lowest bit first, into a byte buffer
+class BitWriter
+{
+public:
+	explicit BitWriter(std::vector<sf::Uint8>& buffer);
+	//Only counts the bits, for measuring an encoding without building it
+	BitWriter();
+
+	void write(sf::Uint32 value, unsigned int bits);
+	void writeBool(bool value);
+	//Two bits pick a width of 4, 8, 16 or 32 bits, so small values stay small
+	void writeCompact(sf::Uint32 value);
+	void writeCompactSigned(sf::Int32 value);
+
+	std::size_t getBitCount() const;
+
+private:
+	// Null when only counting
+	std::vector<sf::Uint8>* mBuffer;
+	std::size_t mBitCount;
+};
+
+//Reads what a BitWriter wrote; reading past the end yields zeroes and clears isValid()
+class BitReader
+{
+public:
+	BitReader(const sf::Uint8* data, std::size_t size);
+
+	sf::Uint32 read(unsigned int bits);
+	bool readBool();
+	sf::Uint32 readCompact();
+	sf::Int32 readCompactSigned();
+
+	bool isValid() const;
+
+private:
+	const sf::Uint8* mData;
+	std::size_t mSize;
+	std::size_t mBitPosition;
+	bool mValid;
+};
@@ -5,6 +5,7 @@ BloomEffect::BloomEffect()
 	, mBrightnessTexture()
 	, mFirstPassTextures()
 	, mSecondPassTextures()
+	, mProfiler(nullptr)
 {
 	mShaders.load(ShaderID::BrightnessPass, "Media/Shaders/Fullpass.vert", "Media/Shaders/Brightness.frag");
 	mShaders.load(ShaderID::DownSamplePass, "Media/Shaders/Fullpass.vert", "Media/Shaders/DownSample.frag");
@@ -29,6 +30,11 @@ void BloomEffect::apply(const sf::RenderTexture& input, sf::RenderTarget& output
 	add(input, mFirstPassTextures[1], output);
 }
 
+void BloomEffect::setProfiler(Profiler* profiler)
+{
+	mProfiler = profiler;
+}
+
 void BloomEffect::prepareTextures(sf::Vector2u size)
 {
 	if (mBrightnessTexture.getSize() != size)
@@ -50,6 +56,7 @@ void BloomEffect::prepareTextures(sf::Vector2u size)
 
 void BloomEffect::filterBright(const sf::RenderTexture& input, sf::RenderTexture& output)
 {
+	Profiler::Scope scope(mProfiler, ProfileSectionID::BloomBrightness);
 	sf::Shader& brightness = mShaders.get(ShaderID::BrightnessPass);
 
 	brightness.setUniform("source", input.getTexture());
@@ -70,6 +77,7 @@ void BloomEffect::blurMultipass(RenderTextureArray& renderTextures)
 
 void BloomEffect::blur(const sf::RenderTexture& input, sf::RenderTexture& output, sf::Vector2f offsetFactor)
 {
+	Profiler::Scope scope(mProfiler, ProfileSectionID::BloomBlur);
 	sf::Shader& gaussianBlur = mShaders.get(ShaderID::GaussianBlurPass);
 
 	gaussianBlur.setUniform("source", input.getTexture());
@@ -80,6 +88,7 @@ void BloomEffect::blur(const sf::RenderTexture& input, sf::RenderTexture& output
 
 void BloomEffect::downsample(const sf::RenderTexture& input, sf::RenderTexture& output)
 {
+	Profiler::Scope scope(mProfiler, ProfileSectionID::BloomDownsample);
 	sf::Shader& downSampler = mShaders.get(ShaderID::DownSamplePass);
 
 	downSampler.setUniform("source", input.getTexture());
@@ -90,6 +99,7 @@ void BloomEffect::downsample(const sf::RenderTexture& input, sf::RenderTexture&
 
 void BloomEffect::add(const sf::RenderTexture& source, const sf::RenderTexture& bloom, sf::RenderTarget& output)
 {
+	Profiler::Scope scope(mProfiler, ProfileSectionID::BloomAdd);
 	sf::Shader& adder = mShaders.get(ShaderID::AddPass);
 
 	adder.setUniform("source", source.getTexture());
@@ -5,6 +5,7 @@
 #include "ResourceIdentifiers.hpp"
 #include "ResourceHolder.hpp"
 #include "ShaderID.hpp"
+#include "Profiler.hpp"
 
 #include <SFML/Graphics/RenderTexture.hpp>
 #include <SFML/Graphics/Shader.hpp>
@@ -18,6 +19,7 @@ public:
 	BloomEffect();
 
 	virtual void		apply(const sf::RenderTexture& input, sf::RenderTarget& output);
+	void				setProfiler(Profiler* profiler);
 
 
 private:
@@ -40,4 +42,6 @@ private:
 	sf::RenderTexture	mBrightnessTexture;
 	RenderTextureArray	mFirstPassTextures;
 	RenderTextureArray	mSecondPassTextures;
+
+	Profiler*			mProfiler;
 };
@@ -0,0 +1,331 @@
+#include "BulletSystem.hpp"
+#include "DataTables.hpp"
+#include "ResourceHolder.hpp"
+#include "CollisionGrid.hpp"
+#include "Utility.hpp"
+#include "SpriteBatch.hpp"
+#include "RenderFrame.hpp"
+#include "IdentifierSequence.hpp"
+
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Texture.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+	const std::vector<ProjectileData> Table = initializeProjectileData();
+
+	// Bullets travel sideways, so their sprite is turned the same way Aircraft::createProjectile turns it
+	const float BulletRotation = 90.f;
+	const std::size_t InitialCapacity = 512;
+}
+
+BulletSystem::BulletSystem(const TextureHolder& textures, IdentifierSequence& identifiers)
+	: SceneNode()
+	, mTexture(textures.get(Table[static_cast<int>(ProjectileID::AlliedBullet)].texture))
+	, mIdentifiers(identifiers)
+	, mPage(&mTexture)
+	, mPageOffset()
+	, mShapes(static_cast<int>(ProjectileID::TypeCount))
+	, mPositionX()
+	, mPositionY()
+	, mVelocityX()
+	, mVelocityY()
+	, mLifetime()
+	, mDamage()
+	, mType()
+	, mIdentifier()
+	, mStep(0.f)
+	, mInterpolation(1.f)
+	, mVertexArray(sf::Quads)
+	, mNeedsVertexUpdate(true)
+{
+	// One batch needs one texture for every bullet type
+	assert(Table[static_cast<int>(ProjectileID::AlliedBullet)].texture == Table[static_cast<int>(ProjectileID::EnemyBullet)].texture);
+
+	float radians = toRadian(BulletRotation);
+	float cosine = std::cos(radians);
+	float sine = std::sin(radians);
+
+	for (std::size_t type = 0; type < mShapes.size(); ++type)
+	{
+		sf::IntRect rect = Table[type].textureRect;
+		sf::Vector2f size(static_cast<float>(rect.width), static_cast<float>(rect.height));
+		sf::Vector2f origin(std::floor(size.x / 2.f), std::floor(size.y / 2.f));
+
+		const sf::Vector2f local[4] = { sf::Vector2f(0.f, 0.f), sf::Vector2f(size.x, 0.f), size, sf::Vector2f(0.f, size.y) };
+
+		Shape& shape = mShapes[type];
+		sf::Vector2f min(0.f, 0.f);
+		sf::Vector2f max(0.f, 0.f);
+
+		for (std::size_t i = 0; i < 4; ++i)
+		{
+			sf::Vector2f corner = local[i] - origin;
+			shape.corners[i] = sf::Vector2f(corner.x * cosine - corner.y * sine, corner.x * sine + corner.y * cosine);
+			shape.texCoords[i] = sf::Vector2f(static_cast<float>(rect.left), static_cast<float>(rect.top)) + local[i];
+
+			min.x = (i == 0) ? shape.corners[i].x : std::min(min.x, shape.corners[i].x);
+			min.y = (i == 0) ? shape.corners[i].y : std::min(min.y, shape.corners[i].y);
+			max.x = (i == 0) ? shape.corners[i].x : std::max(max.x, shape.corners[i].x);
+			max.y = (i == 0) ? shape.corners[i].y : std::max(max.y, shape.corners[i].y);
+		}
+
+		shape.bounds = sf::FloatRect(min, max - min);
+	}
+
+	mPositionX.reserve(InitialCapacity);
+	mPositionY.reserve(InitialCapacity);
+	mVelocityX.reserve(InitialCapacity);
+	mVelocityY.reserve(InitialCapacity);
+	mLifetime.reserve(InitialCapacity);
+	mDamage.reserve(InitialCapacity);
+	mType.reserve(InitialCapacity);
+	mIdentifier.reserve(InitialCapacity);
+}
+
+void BulletSystem::spawn(ProjectileID type, sf::Vector2f position, sf::Vector2f direction)
+{
+	const ProjectileData& data = Table[static_cast<int>(type)];
+
+	mPositionX.push_back(position.x);
+	mPositionY.push_back(position.y);
+	mVelocityX.push_back(direction.x * data.speed);
+	mVelocityY.push_back(direction.y * data.speed);
+	mLifetime.push_back(data.lifetime.asSeconds());
+	mDamage.push_back(data.damage);
+	mType.push_back(static_cast<std::uint8_t>(type));
+	mIdentifier.push_back(mIdentifiers.allocate());
+}
+
+void BulletSystem::destroy(std::size_t index)
+{
+	// Expired bullets are compacted away in the next update, so indices stay valid until then
+	mLifetime[index] = 0.f;
+}
+
+void BulletSystem::destroyOutside(const sf::FloatRect& bounds)
+{
+	for (std::size_t i = 0; i < mPositionX.size(); ++i)
+	{
+		sf::FloatRect rect = mShapes[mType[i]].bounds;
+		rect.left += mPositionX[i];
+		rect.top += mPositionY[i];
+
+		if (!bounds.intersects(rect))
+			destroy(i);
+	}
+}
+
+int BulletSystem::getDamage(std::size_t index) const
+{
+	return mDamage[index];
+}
+
+std::size_t BulletSystem::getBulletCount() const
+{
+	return mPositionX.size();
+}
+
+unsigned int BulletSystem::getIdentifier(std::size_t index) const
+{
+	return mIdentifier[index];
+}
+
+ProjectileID BulletSystem::getType(std::size_t index) const
+{
+	return static_cast<ProjectileID>(mType[index]);
+}
+
+sf::Vector2f BulletSystem::getPosition(std::size_t index) const
+{
+	return sf::Vector2f(mPositionX[index], mPositionY[index]);
+}
+
+sf::Vector2f BulletSystem::getVelocity(std::size_t index) const
+{
+	return sf::Vector2f(mVelocityX[index], mVelocityY[index]);
+}
+
+void BulletSystem::saveState(State& state) const
+{
+	state.positionX = mPositionX;
+	state.positionY = mPositionY;
+	state.velocityX = mVelocityX;
+	state.velocityY = mVelocityY;
+	state.lifetime = mLifetime;
+	state.damage = mDamage;
+	state.type = mType;
+	state.identifier = mIdentifier;
+}
+
+void BulletSystem::restoreState(const State& state)
+{
+	mPositionX = state.positionX;
+	mPositionY = state.positionY;
+	mVelocityX = state.velocityX;
+	mVelocityY = state.velocityY;
+	mLifetime = state.lifetime;
+	mDamage = state.damage;
+	mType = state.type;
+	mIdentifier = state.identifier;
+	mNeedsVertexUpdate = true;
+}
+
+unsigned int BulletSystem::getCategory() const
+{
+	return static_cast<int>(CategoryID::BulletSystem);
+}
+
+void BulletSystem::updateCurrent(sf::Time dt, CommandQueue&)
+{
+	mStep = dt.asSeconds();
+	integrate(mStep);
+	removeExpired();
+
+	mNeedsVertexUpdate = true;
+}
+
+void BulletSystem::drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const
+{
+	if (mNeedsVertexUpdate)
+	{
+		computeVertices();
+		mNeedsVertexUpdate = false;
+	}
+
+	// Bullet positions are in world space; the system sits directly under an untransformed layer
+	states.texture = mPage;
+	target.draw(mVertexArray, states);
+}
+
+void BulletSystem::batchCurrent(SpriteBatch& batch, sf::RenderStates states) const
+{
+	if (batch.getInterpolation() != mInterpolation)
+	{
+		mInterpolation = batch.getInterpolation();
+		mNeedsVertexUpdate = true;
+	}
+
+	const TextureAtlas::Region* region = batch.findRegion(&mTexture);
+	const sf::Texture* page = region ? region->page : &mTexture;
+	sf::Vector2f offset = region ? region->offset : sf::Vector2f();
+
+	if (page != mPage || offset != mPageOffset)
+	{
+		mPage = page;
+		mPageOffset = offset;
+		mNeedsVertexUpdate = true;
+	}
+
+	batch.drawCustom(*this, states);
+}
+
+void BulletSystem::recordCurrent(RenderFrame& frame, sf::RenderStates states) const
+{
+	if (mNeedsVertexUpdate)
+	{
+		computeVertices();
+		mNeedsVertexUpdate = false;
+	}
+
+	if (mVertexArray.getVertexCount() == 0)
+		return;
+
+	states.texture = mPage;
+	frame.addVertices(&mVertexArray[0], mVertexArray.getVertexCount(), mVertexArray.getPrimitiveType(), states);
+}
+
+void BulletSystem::collectCurrentColliders(CollisionGrid& grid)
+{
+	for (std::size_t i = 0; i < mPositionX.size(); ++i)
+	{
+		if (mLifetime[i] <= 0.f)
+			continue;
+
+		sf::FloatRect bounds = mShapes[mType[i]].bounds;
+		bounds.left += mPositionX[i];
+		bounds.top += mPositionY[i];
+
+		CategoryID category = (mType[i] == static_cast<std::uint8_t>(ProjectileID::EnemyBullet)) ? CategoryID::EnemyBullet : CategoryID::AlliedBullet;
+		grid.insert(*this, i, static_cast<unsigned int>(category), bounds);
+	}
+}
+
+void BulletSystem::integrate(float dt)
+{
+	// Plain loops over separate arrays, so the compiler can vectorize them
+	const std::size_t count = mPositionX.size();
+	float* positionX = mPositionX.data();
+	float* positionY = mPositionY.data();
+	const float* velocityX = mVelocityX.data();
+	const float* velocityY = mVelocityY.data();
+	float* lifetime = mLifetime.data();
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		positionX[i] += velocityX[i] * dt;
+		positionY[i] += velocityY[i] * dt;
+		lifetime[i] -= dt;
+	}
+}
+
+void BulletSystem::removeExpired()
+{
+	// Stable compaction keeps spawn order, so collisions and drawing stay deterministic
+	std::size_t alive = 0;
+	for (std::size_t i = 0; i < mPositionX.size(); ++i)
+	{
+		if (mLifetime[i] <= 0.f)
+			continue;
+
+		if (alive != i)
+		{
+			mPositionX[alive] = mPositionX[i];
+			mPositionY[alive] = mPositionY[i];
+			mVelocityX[alive] = mVelocityX[i];
+			mVelocityY[alive] = mVelocityY[i];
+			mLifetime[alive] = mLifetime[i];
+			mDamage[alive] = mDamage[i];
+			mType[alive] = mType[i];
+			mIdentifier[alive] = mIdentifier[i];
+		}
+		++alive;
+	}
+
+	mPositionX.resize(alive);
+	mPositionY.resize(alive);
+	mVelocityX.resize(alive);
+	mVelocityY.resize(alive);
+	mLifetime.resize(alive);
+	mDamage.resize(alive);
+	mType.resize(alive);
+	mIdentifier.resize(alive);
+}
+
+void BulletSystem::computeVertices() const
+{
+	// Write the quads in place; the vertex array keeps its capacity between frames
+	const std::size_t count = mPositionX.size();
+	mVertexArray.resize(count * 4);
+
+	// Drawn part of the way back along the last step when the picture is between two ticks
+	const float rewind = (1.f - mInterpolation) * mStep;
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const Shape& shape = mShapes[mType[i]];
+		sf::Vector2f position(mPositionX[i] - mVelocityX[i] * rewind, mPositionY[i] - mVelocityY[i] * rewind);
+
+		for (std::size_t corner = 0; corner < 4; ++corner)
+		{
+			sf::Vertex& vertex = mVertexArray[i * 4 + corner];
+			vertex.position = position + shape.corners[corner];
+			vertex.texCoords = mPageOffset + shape.texCoords[corner];
+			vertex.color = sf::Color::White;
+		}
+	}
+}
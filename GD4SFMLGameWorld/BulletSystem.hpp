@@ -0,0 +1,96 @@
+#pragma once
+#include "SceneNode.hpp"
+#include "ResourceIdentifiers.hpp"
+#include "ProjectileID.hpp"
+
+#include <SFML/Graphics/VertexArray.hpp>
+#include <SFML/Graphics/Rect.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class IdentifierSequence;
+
+//All unguided bullets in one node, stored as parallel arrays and drawn as a single vertex batch
+class BulletSystem : public SceneNode
+{
+public:
+	// The arrays as they are; a kept State reuses its storage, so saving every tick does not allocate
+	struct State
+	{
+		std::vector<float> positionX;
+		std::vector<float> positionY;
+		std::vector<float> velocityX;
+		std::vector<float> velocityY;
+		std::vector<float> lifetime;
+		std::vector<int> damage;
+		std::vector<std::uint8_t> type;
+		std::vector<unsigned int> identifier;
+	};
+
+public:
+	//Bullets are replicated like entities, so they are named from identifiers, the sequence of the World
+	BulletSystem(const TextureHolder& textures, IdentifierSequence& identifiers);
+
+	void spawn(ProjectileID type, sf::Vector2f position, sf::Vector2f direction);
+	void destroy(std::size_t index);
+	void destroyOutside(const sf::FloatRect& bounds);
+
+	int getDamage(std::size_t index) const;
+	std::size_t getBulletCount() const;
+
+	// Per-bullet state for snapshots
+	unsigned int getIdentifier(std::size_t index) const;
+	ProjectileID getType(std::size_t index) const;
+	sf::Vector2f getPosition(std::size_t index) const;
+	sf::Vector2f getVelocity(std::size_t index) const;
+
+	void saveState(State& state) const;
+	void restoreState(const State& state);
+
+	virtual unsigned int getCategory() const;
+
+private:
+	virtual void updateCurrent(sf::Time dt, CommandQueue& commands);
+	virtual void drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const;
+	virtual void batchCurrent(SpriteBatch& batch, sf::RenderStates states) const;
+	virtual void recordCurrent(RenderFrame& frame, sf::RenderStates states) const;
+	virtual void collectCurrentColliders(CollisionGrid& grid);
+
+	void integrate(float dt);
+	void removeExpired();
+	void computeVertices() const;
+
+private:
+	// Quad corners of a bullet relative to its position, with the sprite's rotation baked in
+	struct Shape
+	{
+		std::array<sf::Vector2f, 4> corners;
+		std::array<sf::Vector2f, 4> texCoords;
+		sf::FloatRect bounds;
+	};
+
+	const sf::Texture& mTexture;
+	IdentifierSequence& mIdentifiers;
+	// Where mTexture was packed, if the batch has an atlas; texture coordinates are shifted by the page offset
+	mutable const sf::Texture* mPage;
+	mutable sf::Vector2f mPageOffset;
+	std::vector<Shape> mShapes;
+
+	std::vector<float> mPositionX;
+	std::vector<float> mPositionY;
+	std::vector<float> mVelocityX;
+	std::vector<float> mVelocityY;
+	std::vector<float> mLifetime;
+	std::vector<int> mDamage;
+	std::vector<std::uint8_t> mType;
+	std::vector<unsigned int> mIdentifier;
+
+	// Bullets fly straight, so where they were a tick ago follows from their velocity and the last step
+	float mStep;
+	mutable float mInterpolation;
+
+	mutable sf::VertexArray mVertexArray;
+	mutable bool mNeedsVertexUpdate;
+};
@@ -13,6 +13,9 @@ enum class CategoryID
 	EnemyProjectile = 1 << 6,
 	ParticleSystem = 1 << 7,
 	SoundEffect = 1 << 8,
+	BulletSystem = 1 << 9,
+	AlliedBullet = 1 << 10,
+	EnemyBullet = 1 << 11,
 
 	Aircraft = PlayerAircraft | Player2Aircraft | EnemyAircraft,
 	Projectile = AlliedProjectile | EnemyProjectile,
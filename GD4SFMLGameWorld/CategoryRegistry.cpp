@@ -0,0 +1,86 @@
+#include "CategoryRegistry.hpp"
+#include "SceneNode.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+CategoryRegistry::CategoryRegistry()
+	: mNodes()
+	, mNodeCount(0)
+	, mDispatching(false)
+{
+}
+
+void CategoryRegistry::add(SceneNode& node)
+{
+	unsigned int category = node.getCategory();
+	if (category == 0)
+		return;
+
+	Entry entry = { &node, category };
+	for (std::size_t bit = 0; bit < CategoryBits; ++bit)
+	{
+		if (category & (1u << bit))
+			mNodes[bit].push_back(entry);
+	}
+
+	++mNodeCount;
+}
+
+void CategoryRegistry::remove(SceneNode& node)
+{
+	// Nodes only leave between commands (wreck removal, detaching), never while one is delivered
+	assert(!mDispatching);
+
+	unsigned int category = node.getCategory();
+	if (category == 0)
+		return;
+
+	for (std::size_t bit = 0; bit < CategoryBits; ++bit)
+	{
+		if (!(category & (1u << bit)))
+			continue;
+
+		// Stable erase keeps attach order, so delivery order stays deterministic
+		std::vector<Entry>& entries = mNodes[bit];
+		auto found = std::find_if(entries.begin(), entries.end(), [&](const Entry& entry) { return entry.node == &node; });
+		assert(found != entries.end());
+		entries.erase(found);
+	}
+
+	--mNodeCount;
+}
+
+void CategoryRegistry::dispatch(const Command& command, sf::Time dt)
+{
+	mDispatching = true;
+
+	for (std::size_t bit = 0; bit < CategoryBits; ++bit)
+	{
+		unsigned int mask = 1u << bit;
+		if (!(command.category & mask))
+			continue;
+
+		// Nodes attached by an action join the list but do not receive the command being delivered
+		std::vector<Entry>& entries = mNodes[bit];
+		const std::size_t count = entries.size();
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			Entry entry = entries[i];
+
+			// A node matching several bits of the command is only visited from its lowest one
+			if (entry.category & command.category & (mask - 1))
+				continue;
+
+			command.action(*entry.node, dt);
+		}
+	}
+
+	mDispatching = false;
+}
+
+std::size_t CategoryRegistry::getNodeCount() const
+{
+	return mNodeCount;
+}
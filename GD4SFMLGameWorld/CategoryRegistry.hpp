@@ -0,0 +1,37 @@
+#pragma once
+#include "Command.hpp"
+
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
+
+#include <array>
+#include <vector>
+
+class SceneNode;
+
+//Scene nodes listed per category bit, so a command only visits the nodes it is meant for
+class CategoryRegistry : private sf::NonCopyable
+{
+public:
+	CategoryRegistry();
+
+	void add(SceneNode& node);
+	void remove(SceneNode& node);
+
+	void dispatch(const Command& command, sf::Time dt);
+	std::size_t getNodeCount() const;
+
+private:
+	struct Entry
+	{
+		SceneNode* node;
+		unsigned int category;
+	};
+
+	static const std::size_t CategoryBits = 32;
+
+private:
+	std::array<std::vector<Entry>, CategoryBits> mNodes;
+	std::size_t mNodeCount;
+	bool mDispatching;
+};
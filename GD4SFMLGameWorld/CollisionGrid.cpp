@@ -0,0 +1,134 @@
+#include "CollisionGrid.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+CollisionGrid::CollisionGrid(float cellSize)
+	: mCellSize(cellSize)
+	, mColliders()
+	, mCells()
+	, mUsedCells()
+{
+}
+
+void CollisionGrid::clear()
+{
+	// Keep the cell buckets alive so their storage is reused next tick
+	for (std::uint64_t key : mUsedCells)
+		mCells[key].clear();
+
+	mUsedCells.clear();
+	mColliders.clear();
+}
+
+void CollisionGrid::insert(SceneNode& node)
+{
+	insert(node, 0, node.getCategory(), node.getBoundingRect());
+}
+
+void CollisionGrid::insert(SceneNode& node, std::size_t index, unsigned int category, const sf::FloatRect& bounds)
+{
+	Collider collider;
+	collider.body.node = &node;
+	collider.body.index = index;
+	collider.body.category = category;
+	collider.bounds = bounds;
+
+	std::size_t slot = mColliders.size();
+	mColliders.push_back(collider);
+
+	int left = cellCoordinate(collider.bounds.left);
+	int top = cellCoordinate(collider.bounds.top);
+	int right = cellCoordinate(collider.bounds.left + collider.bounds.width);
+	int bottom = cellCoordinate(collider.bounds.top + collider.bounds.height);
+
+	for (int x = left; x <= right; ++x)
+	{
+		for (int y = top; y <= bottom; ++y)
+		{
+			std::vector<std::size_t>& cell = mCells[cellKey(x, y)];
+			if (cell.empty())
+				mUsedCells.push_back(cellKey(x, y));
+
+			cell.push_back(slot);
+		}
+	}
+}
+
+void CollisionGrid::findContacts(const CollisionMatrix& matrix, std::vector<CollisionMatrix::Contact>& contacts) const
+{
+	// Cells are visited in insertion order, so the pair order does not depend on pointer values
+	for (std::size_t i = 0; i < mUsedCells.size(); ++i)
+		findCellContacts(i, matrix, contacts);
+}
+
+void CollisionGrid::findContacts(const CollisionMatrix& matrix, std::vector<CollisionMatrix::Contact>& contacts,
+	JobSystem& jobs, std::vector<std::vector<CollisionMatrix::Contact>>& chunkContacts) const
+{
+	// Testing only reads the grid; every chunk takes consecutive cells, so appending the chunks in order
+	// gives the pairs in the same order as testing the cells one after another
+	std::size_t chunkCount = std::min(chunkContacts.size(), mUsedCells.size());
+	if (chunkCount <= 1)
+	{
+		findContacts(matrix, contacts);
+		return;
+	}
+
+	std::size_t cellCount = mUsedCells.size();
+	jobs.run(chunkCount, [&] (std::size_t chunk)
+	{
+		chunkContacts[chunk].clear();
+		for (std::size_t i = chunk * cellCount / chunkCount; i < (chunk + 1) * cellCount / chunkCount; ++i)
+			findCellContacts(i, matrix, chunkContacts[chunk]);
+	});
+
+	for (std::size_t chunk = 0; chunk < chunkCount; ++chunk)
+		contacts.insert(contacts.end(), chunkContacts[chunk].begin(), chunkContacts[chunk].end());
+}
+
+std::size_t CollisionGrid::getColliderCount() const
+{
+	return mColliders.size();
+}
+
+std::uint64_t CollisionGrid::cellKey(int x, int y) const
+{
+	return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+}
+
+int CollisionGrid::cellCoordinate(float value) const
+{
+	return static_cast<int>(std::floor(value / mCellSize));
+}
+
+void CollisionGrid::findCellContacts(std::size_t cellIndex, const CollisionMatrix& matrix, std::vector<CollisionMatrix::Contact>& contacts) const
+{
+	std::uint64_t key = mUsedCells[cellIndex];
+	const std::vector<std::size_t>& cell = mCells.find(key)->second;
+
+	for (std::size_t i = 0; i < cell.size(); ++i)
+	{
+		const Collider& first = mColliders[cell[i]];
+
+		for (std::size_t j = i + 1; j < cell.size(); ++j)
+		{
+			const Collider& second = mColliders[cell[j]];
+
+			// Reject pairs without a declared response before touching their bounds
+			CollisionMatrix::Contact contact;
+			if (!matrix.makeContact(first.body, second.body, contact))
+				continue;
+
+			sf::FloatRect overlap;
+			if (!first.bounds.intersects(second.bounds, overlap))
+				continue;
+
+			// A pair sharing several cells is only reported by the cell containing the overlap's corner
+			if (cellKey(cellCoordinate(overlap.left), cellCoordinate(overlap.top)) != key)
+				continue;
+
+			contacts.push_back(contact);
+		}
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "SceneNode.hpp"
+#include "CollisionMatrix.hpp"
+
+#include <SFML/Graphics/Rect.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class JobSystem;
+
+//Uniform grid broadphase, rebuilt once per tick from the collidable scene nodes
+class CollisionGrid
+{
+public:
+	explicit CollisionGrid(float cellSize);
+
+	void clear();
+	void insert(SceneNode& node);
+	void insert(SceneNode& node, std::size_t index, unsigned int category, const sf::FloatRect& bounds);
+	void findContacts(const CollisionMatrix& matrix, std::vector<CollisionMatrix::Contact>& contacts) const;
+	// Same contacts in the same order, with the cells tested in chunks on the job system
+	// Each chunk of cells fills its own list, and the lists are appended in cell order
+	void findContacts(const CollisionMatrix& matrix, std::vector<CollisionMatrix::Contact>& contacts,
+		JobSystem& jobs, std::vector<std::vector<CollisionMatrix::Contact>>& chunkContacts) const;
+
+	std::size_t getColliderCount() const;
+
+private:
+	struct Collider
+	{
+		CollisionMatrix::Body body;
+		sf::FloatRect bounds;
+	};
+
+	std::uint64_t cellKey(int x, int y) const;
+	int cellCoordinate(float value) const;
+	void findCellContacts(std::size_t cellIndex, const CollisionMatrix& matrix, std::vector<CollisionMatrix::Contact>& contacts) const;
+
+private:
+	float mCellSize;
+	std::vector<Collider> mColliders;
+	std::unordered_map<std::uint64_t, std::vector<std::size_t>> mCells;
+	std::vector<std::uint64_t> mUsedCells;
+};
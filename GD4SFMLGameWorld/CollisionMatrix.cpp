@@ -0,0 +1,84 @@
+#include "CollisionMatrix.hpp"
+
+#include <cassert>
+
+CollisionMatrix::CollisionMatrix()
+	: mInteractionMasks()
+	, mRules()
+	, mResponses()
+{
+	mInteractionMasks.fill(0);
+
+	Cell empty = { NoRule, false };
+	for (auto& row : mRules)
+		row.fill(empty);
+}
+
+void CollisionMatrix::add(CategoryID type1, CategoryID type2, Response response)
+{
+	assert(mResponses.size() < NoRule);
+
+	unsigned int category1 = static_cast<unsigned int>(type1);
+	unsigned int category2 = static_cast<unsigned int>(type2);
+	std::uint16_t rule = static_cast<std::uint16_t>(mResponses.size());
+	mResponses.push_back(std::move(response));
+
+	// Store the rule in both directions, remembering which way round the response expects the nodes
+	for (std::size_t bit1 = 0; bit1 < CategoryBits; ++bit1)
+	{
+		if (!(category1 & (1u << bit1)))
+			continue;
+
+		mInteractionMasks[bit1] |= category2;
+
+		for (std::size_t bit2 = 0; bit2 < CategoryBits; ++bit2)
+		{
+			if (!(category2 & (1u << bit2)))
+				continue;
+
+			mInteractionMasks[bit2] |= category1;
+
+			Cell forward = { rule, false };
+			Cell backward = { rule, true };
+			mRules[bit1][bit2] = forward;
+			mRules[bit2][bit1] = backward;
+		}
+	}
+}
+
+bool CollisionMatrix::makeContact(const Body& body1, const Body& body2, Contact& contact) const
+{
+	Cell cell;
+	if (!findRule(body1.category, body2.category, cell))
+		return false;
+
+	// Order the bodies the way the response was declared
+	contact.first = cell.swapped ? body2 : body1;
+	contact.second = cell.swapped ? body1 : body2;
+	contact.rule = cell.rule;
+	return true;
+}
+
+void CollisionMatrix::respond(const Contact& contact) const
+{
+	mResponses[contact.rule](contact);
+}
+
+bool CollisionMatrix::findRule(unsigned int category1, unsigned int category2, Cell& result) const
+{
+	for (std::size_t bit1 = 0; bit1 < CategoryBits; ++bit1)
+	{
+		if (!(category1 & (1u << bit1)) || !(mInteractionMasks[bit1] & category2))
+			continue;
+
+		for (std::size_t bit2 = 0; bit2 < CategoryBits; ++bit2)
+		{
+			if ((category2 & (1u << bit2)) && mRules[bit1][bit2].rule != NoRule)
+			{
+				result = mRules[bit1][bit2];
+				return true;
+			}
+		}
+	}
+	return false;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "CategoryID.hpp"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class SceneNode;
+
+//Declares which category pairs collide and how each pair responds
+class CollisionMatrix
+{
+public:
+	// A collider is a scene node, or one element of a node that stores many of them (e.g. bullets)
+	struct Body
+	{
+		SceneNode* node;
+		std::size_t index;
+		unsigned int category;
+	};
+
+	struct Contact
+	{
+		Body first;
+		Body second;
+		std::size_t rule;
+	};
+
+	typedef std::function<void(const Contact&)> Response;
+
+public:
+	CollisionMatrix();
+
+	void add(CategoryID type1, CategoryID type2, Response response);
+
+	bool makeContact(const Body& body1, const Body& body2, Contact& contact) const;
+	void respond(const Contact& contact) const;
+
+private:
+	struct Cell
+	{
+		std::uint16_t rule;
+		bool swapped;
+	};
+
+	static const std::size_t CategoryBits = 32;
+	static const std::uint16_t NoRule = 0xffff;
+
+	bool findRule(unsigned int category1, unsigned int category2, Cell& result) const;
+
+private:
+	std::array<unsigned int, CategoryBits> mInteractionMasks;
+	std::array<std::array<Cell, CategoryBits>, CategoryBits> mRules;
+	std::vector<Response> mResponses;
+};
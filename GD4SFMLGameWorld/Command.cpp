@@ -1,5 +1,79 @@
 #include "Command.hpp"
 
+CommandAction::CommandAction()
+	: mStorage()
+	, mOperations(nullptr)
+{
+}
+
+CommandAction::CommandAction(CommandAction&& other)
+	: mStorage()
+	, mOperations(other.mOperations)
+{
+	if (mOperations)
+	{
+		mOperations->move(&mStorage, &other.mStorage);
+		other.mOperations = nullptr;
+	}
+}
+
+CommandAction& CommandAction::operator=(CommandAction&& other)
+{
+	if (this != &other)
+	{
+		reset();
+
+		mOperations = other.mOperations;
+		if (mOperations)
+		{
+			mOperations->move(&mStorage, &other.mStorage);
+			other.mOperations = nullptr;
+		}
+	}
+
+	return *this;
+}
+
+CommandAction::~CommandAction()
+{
+	reset();
+}
+
+CommandAction::operator bool() const
+{
+	return mOperations != nullptr;
+}
+
+void CommandAction::operator()(SceneNode& node, sf::Time dt) const
+{
+	assert(mOperations != nullptr);
+	mOperations->invoke(&mStorage, node, dt);
+}
+
+void CommandAction::reset()
+{
+	if (mOperations)
+	{
+		mOperations->destroy(&mStorage);
+		mOperations = nullptr;
+	}
+}
+
 Command::Command() : action(), category(static_cast<int>(CategoryID::None))
 {
 }
+
+Command forwardCommand(const Command& command)
+{
+	// The forwarded command must outlive the queue entry, which holds for bindings and members of live nodes
+	const CommandAction* action = &command.action;
+
+	Command forwarder;
+	forwarder.category = command.category;
+	forwarder.action = [action](SceneNode& node, sf::Time dt)
+	{
+		(*action)(node, dt);
+	};
+
+	return forwarder;
+}
@@ -3,29 +3,89 @@
 #include "CategoryID.hpp"
 #include "SFML/System/Time.hpp"
 
-#include <functional>
 #include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 class SceneNode;
 
+//Move-only callable kept inside the command itself, so building and queueing commands never allocates
+class CommandAction
+{
+public:
+	static const std::size_t BufferSize = 4 * sizeof(void*);
+
+public:
+	CommandAction();
+	CommandAction(CommandAction&& other);
+	CommandAction& operator=(CommandAction&& other);
+	~CommandAction();
+
+	CommandAction(const CommandAction&) = delete;
+	CommandAction& operator=(const CommandAction&) = delete;
+
+	template <typename Function, typename = typename std::enable_if<!std::is_same<typename std::decay<Function>::type, CommandAction>::value>::type>
+	CommandAction(Function fn);
+
+	explicit operator bool() const;
+	void operator()(SceneNode& node, sf::Time dt) const;
+
+private:
+	struct Operations
+	{
+		void(*invoke)(void* storage, SceneNode& node, sf::Time dt);
+		void(*move)(void* destination, void* source);
+		void(*destroy)(void* storage);
+	};
+
+	template <typename Function>
+	struct OperationsFor
+	{
+		static void invoke(void* storage, SceneNode& node, sf::Time dt);
+		static void move(void* destination, void* source);
+		static void destroy(void* storage);
+
+		static const Operations Table;
+	};
+
+	void reset();
+
+private:
+	mutable typename std::aligned_storage<BufferSize, alignof(void*)>::type mStorage;
+	const Operations* mOperations;
+};
+
 struct Command
 {
 	Command();
-	std::function<void(SceneNode&, sf::Time)> action;
+	CommandAction action;
 	unsigned int category;
 };
 
+//Wraps a long-lived command (key bindings, an aircraft's fire command) so it can be queued every tick without copying it
+Command forwardCommand(const Command& command);
+
 template <typename GameObject, typename Function>
-std::function<void(SceneNode&, sf::Time)> derivedAction(Function fn)
+struct DerivedAction
 {
-	return [=](SceneNode& node, sf::Time dt)
+	void operator()(SceneNode& node, sf::Time dt) const
 	{
 		//Check if the cast is safe
 		assert(dynamic_cast<GameObject*>(&node) != nullptr);
 
 		//Downcast node and invoke the function on it
 		fn(static_cast<GameObject&>(node), dt);
+	}
 
-	};
+	Function fn;
+};
+
+template <typename GameObject, typename Function>
+DerivedAction<GameObject, Function> derivedAction(Function fn)
+{
+	return DerivedAction<GameObject, Function>{ fn };
 }
 
+#include "Command.inl"
@@ -0,0 +1,37 @@
+template<typename Function, typename>
+CommandAction::CommandAction(Function fn)
+	: mOperations(&OperationsFor<Function>::Table)
+{
+	// Refuse at compile time anything that would need a heap allocation; capture a pointer instead
+	static_assert(sizeof(Function) <= BufferSize, "Command action does not fit the inline buffer");
+	static_assert(alignof(Function) <= alignof(void*), "Command action is over-aligned for the inline buffer");
+
+	new (&mStorage) Function(std::move(fn));
+}
+
+template<typename Function>
+void CommandAction::OperationsFor<Function>::invoke(void* storage, SceneNode& node, sf::Time dt)
+{
+	(*static_cast<Function*>(storage))(node, dt);
+}
+
+template<typename Function>
+void CommandAction::OperationsFor<Function>::move(void* destination, void* source)
+{
+	new (destination) Function(std::move(*static_cast<Function*>(source)));
+	static_cast<Function*>(source)->~Function();
+}
+
+template<typename Function>
+void CommandAction::OperationsFor<Function>::destroy(void* storage)
+{
+	static_cast<Function*>(storage)->~Function();
+}
+
+template<typename Function>
+const CommandAction::Operations CommandAction::OperationsFor<Function>::Table =
+{
+	&CommandAction::OperationsFor<Function>::invoke,
+	&CommandAction::OperationsFor<Function>::move,
+	&CommandAction::OperationsFor<Function>::destroy
+};
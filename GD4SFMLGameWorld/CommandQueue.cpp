@@ -1,18 +1,60 @@
 #include "CommandQueue.hpp"
 
-void CommandQueue::push(const Command& command)
+#include <utility>
+
+namespace
+{
+	const std::size_t InitialCapacity = 64;
+}
+
+CommandQueue::CommandQueue()
+	: mBuffer()
+	, mHead(0)
+	, mSize(0)
+	, mAllocations(0)
 {
-	mQueue.push(command);
+	grow();
+}
+
+void CommandQueue::push(Command&& command)
+{
+	if (mSize == mBuffer.size())
+		grow();
+
+	// Capacity is a power of two, so wrapping is a mask
+	std::size_t tail = (mHead + mSize) & (mBuffer.size() - 1);
+	mBuffer[tail] = std::move(command);
+	++mSize;
 }
 
 Command CommandQueue::pop()
 {
-	Command command = mQueue.front();
-	mQueue.pop();
-	return Command(command);
+	assert(mSize > 0);
+
+	Command command = std::move(mBuffer[mHead]);
+	mHead = (mHead + 1) & (mBuffer.size() - 1);
+	--mSize;
+	return command;
 }
 
 bool CommandQueue::isEmpty() const
 {
-	return mQueue.empty();
+	return mSize == 0;
+}
+
+std::size_t CommandQueue::getAllocationCount() const
+{
+	return mAllocations;
+}
+
+void CommandQueue::grow()
+{
+	// Double the ring and unwrap the queued commands to the front of the new storage
+	std::vector<Command> buffer(mBuffer.empty() ? InitialCapacity : mBuffer.size() * 2);
+	for (std::size_t i = 0; i < mSize; ++i)
+		buffer[i] = std::move(mBuffer[(mHead + i) & (mBuffer.size() - 1)]);
+
+	mBuffer.swap(buffer);
+	mHead = 0;
+	++mAllocations;
 }
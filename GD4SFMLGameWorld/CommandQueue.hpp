@@ -1,15 +1,28 @@
 #pragma once
 #include "Command.hpp"
 
-#include <queue>
+#include <cstddef>
+#include <vector>
 
+//Ring buffer of commands whose storage is reused from frame to frame
 class CommandQueue
 {
 public:
-	void push(const Command& command);
+	CommandQueue();
+
+	void push(Command&& command);
 	Command pop();
 	bool isEmpty() const;
 
+	//Number of times the ring had to allocate; stays flat once the queue has reached its working size
+	std::size_t getAllocationCount() const;
+
+private:
+	void grow();
+
 private:
-	std::queue<Command> mQueue;
-};
\ No newline at end of file
+	std::vector<Command> mBuffer;
+	std::size_t mHead;
+	std::size_t mSize;
+	std::size_t mAllocations;
+};
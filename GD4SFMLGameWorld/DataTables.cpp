@@ -66,11 +66,13 @@ std::vector<ProjectileData> initializeProjectileData()
 
 	data[static_cast<int>(ProjectileID::AlliedBullet)].damage = 10;
 	data[static_cast<int>(ProjectileID::AlliedBullet)].speed = 300.f;
+	data[static_cast<int>(ProjectileID::AlliedBullet)].lifetime = sf::seconds(5.f);
 	data[static_cast<int>(ProjectileID::AlliedBullet)].texture = TextureID::Entities;
 	data[static_cast<int>(ProjectileID::AlliedBullet)].textureRect = sf::IntRect(175, 64, 3, 14);
 
 	data[static_cast<int>(ProjectileID::EnemyBullet)].damage = 10;
 	data[static_cast<int>(ProjectileID::EnemyBullet)].speed = -300.f;
+	data[static_cast<int>(ProjectileID::EnemyBullet)].lifetime = sf::seconds(5.f);
 	data[static_cast<int>(ProjectileID::EnemyBullet)].texture = TextureID::Entities;
 	data[static_cast<int>(ProjectileID::EnemyBullet)].textureRect = sf::IntRect(175, 64, 3, 14);
 
@@ -111,9 +113,11 @@ std::vector<ParticleData> initializeParticleData()
 
 	data[static_cast<int>(ParticleID::Propellant)].color = sf::Color(255, 255, 50);
 	data[static_cast<int>(ParticleID::Propellant)].lifetime = sf::seconds(0.6f);
+	data[static_cast<int>(ParticleID::Propellant)].capacity = 2048;
 
 	data[static_cast<int>(ParticleID::Smoke)].color = sf::Color(50, 50, 50);
 	data[static_cast<int>(ParticleID::Smoke)].lifetime = sf::seconds(4.f);
+	data[static_cast<int>(ParticleID::Smoke)].capacity = 8192;
 
 	return data;
 }
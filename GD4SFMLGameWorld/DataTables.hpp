@@ -37,6 +37,7 @@ struct ProjectileData
 {
 	int damage;
 	float speed;
+	sf::Time lifetime;
 	TextureID texture;
 	sf::IntRect textureRect;
 };
@@ -52,6 +53,7 @@ struct ParticleData
 {
 	sf::Color color;
 	sf::Time lifetime;
+	std::size_t capacity;
 };
 
 std::vector<AircraftData> initializeAircraftData();
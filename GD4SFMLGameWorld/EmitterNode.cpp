@@ -1,51 +1,41 @@
 #include "EmitterNode.hpp"
 #include "ParticleNode.hpp"
 
-#include <iostream>
-
 EmitterNode::EmitterNode(ParticleID type)
 	:SceneNode()
 	, mAccumulatedTime(sf::Time::Zero)
 	, mType(type)
-	, mParticleSystem(nullptr)
 {
 }
 
 void EmitterNode::updateCurrent(sf::Time dt, CommandQueue& commands)
-{
-	if (mParticleSystem)
-	{
-		emitParticles(dt);
-	}
-	else
-	{
-		//Find particle node that has the same type as me
-		auto finder = [this](ParticleNode& container, sf::Time)
-		{
-			if (container.getParticleType() == mType)
-			{
-				mParticleSystem = &container;
-			}
-		};
-
-		Command command;
-		command.category = static_cast<int>(CategoryID::ParticleSystem);
-		command.action = derivedAction<ParticleNode>(finder);
-
-		commands.push(command);
-	}
-}
-
-void EmitterNode::emitParticles(sf::Time dt)
 {
 	const float emissionRate = 30.f;
 	const sf::Time interval = sf::seconds(1.f) / emissionRate;
 
 	mAccumulatedTime += dt;
 
+	// Particles are handed to the particle node as commands, so emitters never write to the shared node
+	// while entities are updated on several threads
 	while (mAccumulatedTime > interval)
 	{
 		mAccumulatedTime -= interval;
-		mParticleSystem->addParticle(getWorldPosition());
+		emitParticle(commands);
 	}
 }
+
+void EmitterNode::emitParticle(CommandQueue& commands) const
+{
+	ParticleID type = mType;
+	sf::Vector2f position = getWorldPosition();
+
+	Command command;
+	command.category = static_cast<int>(CategoryID::ParticleSystem);
+	command.action = derivedAction<ParticleNode>([type, position](ParticleNode& container, sf::Time)
+	{
+		if (container.getParticleType() == type)
+			container.addParticle(position);
+	});
+
+	commands.push(std::move(command));
+}
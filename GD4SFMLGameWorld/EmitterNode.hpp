@@ -1,10 +1,7 @@
 #pragma once
 #include "SceneNode.hpp"
-#include "Particle.hpp"
 #include "ParticleID.hpp"
 
-class ParticleNode;
-
 class EmitterNode : public SceneNode
 {
 public:
@@ -12,10 +9,9 @@ public:
 
 private:
 	virtual void updateCurrent(sf::Time dt, CommandQueue& commands);
-	void emitParticles(sf::Time dt);
+	void emitParticle(CommandQueue& commands) const;
 
 private:
 	sf::Time mAccumulatedTime;
 	ParticleID mType;
-	ParticleNode* mParticleSystem;
 };
\ No newline at end of file
@@ -1,9 +1,10 @@
 #include "Entity.hpp"
+#include "IdentifierSequence.hpp"
 
 #include <cassert>
 
-Entity::Entity(int hitpoints)
-	: mVelocity(), mHitpoints(hitpoints)
+Entity::Entity(int hitpoints, IdentifierSequence& identifiers)
+	: mVelocity(), mHitpoints(hitpoints), mIdentifier(identifiers.allocate())
 {}
 
 void Entity::setVelocity(sf::Vector2f velocity)
@@ -61,6 +62,41 @@ bool Entity::isDestroyed() const
 	return mHitpoints <= 0;
 }
 
+unsigned int Entity::getIdentifier() const
+{
+	return mIdentifier;
+}
+
+void Entity::setIdentifier(unsigned int identifier)
+{
+	mIdentifier = identifier;
+}
+
+void Entity::saveState(State& state) const
+{
+	state.identifier = mIdentifier;
+	state.position = getPosition();
+	state.rotation = getRotation();
+	state.scale = getScale();
+	state.velocity = mVelocity;
+	state.hitpoints = mHitpoints;
+}
+
+void Entity::restoreState(const State& state)
+{
+	mIdentifier = state.identifier;
+	setPosition(state.position);
+	setRotation(state.rotation);
+	setScale(state.scale);
+	mVelocity = state.velocity;
+	mHitpoints = state.hitpoints;
+}
+
+bool Entity::isCollidable() const
+{
+	return true;
+}
+
 void Entity::updateCurrent(sf::Time dt, CommandQueue&)
 {
 	move(mVelocity * dt.asSeconds());
@@ -3,10 +3,25 @@
 #include "SceneNode.hpp"
 #include "CommandQueue.hpp"
 
+class IdentifierSequence;
+
 class Entity : public SceneNode
 {
 public:
-	Entity(int hitpoints);
+	//Everything World::restoreState needs to put an entity back exactly as it was at a saved tick
+	struct State
+	{
+		unsigned int identifier;
+		sf::Vector2f position;
+		float rotation;
+		sf::Vector2f scale;
+		sf::Vector2f velocity;
+		int hitpoints;
+	};
+
+public:
+	//The identifier comes from identifiers, the sequence of the World the entity belongs to
+	Entity(int hitpoints, IdentifierSequence& identifiers);
 	void setVelocity(sf::Vector2f velocity);
 	void setVelocity(float vx, float vy);
 	void accelerate(sf::Vector2f velocity);
@@ -18,6 +33,14 @@ public:
 	void damage(int points);
 	void destroy();
 	virtual bool isDestroyed() const;
+	virtual bool isCollidable() const;
+
+	//Names the entity in network snapshots; unique among live entities, replicas adopt the server's value
+	unsigned int getIdentifier() const;
+	void setIdentifier(unsigned int identifier);
+
+	void saveState(State& state) const;
+	void restoreState(const State& state);
 
 protected:
 	virtual void updateCurrent(sf::Time dt, CommandQueue& commands);
@@ -25,4 +48,5 @@ protected:
 private:
 	sf::Vector2f mVelocity;
 	int mHitpoints;
+	unsigned int mIdentifier;
 };
\ No newline at end of file
@@ -38,16 +38,16 @@ void Game::processInput()
 	sf::Event event;
 	while (mWindow.pollEvent(event))
 	{
-		mPlayer.handleEvent(event, commands);
-		mPlayer2.handleEvent(event, commands);
+		mPlayer.recordEvent(event);
+		mPlayer2.recordEvent(event);
 
 		if (event.type == sf::Event::Closed)
 		{
 			mWindow.close();
 		}
 	}
-	mPlayer.handleRealtimeInput(commands);
-	mPlayer2.handleRealtimeInput(commands);
+	mPlayer.applyActions(mPlayer.sampleActions(), commands);
+	mPlayer2.applyActions(mPlayer2.sampleActions(), commands);
 }
 
 void Game::update(sf::Time deltaTime)
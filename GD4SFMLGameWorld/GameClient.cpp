@@ -0,0 +1,295 @@
+#include "GameClient.hpp"
+#include "World.hpp"
+#include "PacketID.hpp"
+#include "Application.hpp"
+
+#include <SFML/Network/Packet.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+GameClient::GameClient(World& world, const sf::IpAddress& server, unsigned short port)
+	: mWorld(world)
+	, mPlayer()
+	, mPlayer2()
+	, mSocket()
+	, mServerAddress(server)
+	, mServerPort(port)
+	, mClock()
+	, mLastHeard()
+	, mLastHello(sf::seconds(-1.f))
+	, mConnected(false)
+	, mStarted(false)
+	, mServerFull(false)
+	, mSlot(0)
+	, mTick(0)
+	, mStartTick(0)
+	, mInputLead(InputLead)
+	, mInputs()
+	, mPredictions()
+	, mSnapshotHistory()
+	, mPredictedIdentifier(0)
+	, mLastCorrection()
+	, mReceivedBytes(0)
+{
+	mSocket.bind(sf::Socket::AnyPort);
+	mSocket.setBlocking(false);
+
+	mWorld.setReplica(true);
+}
+
+GameClient::~GameClient()
+{
+	if (!mConnected)
+		return;
+
+	sf::Packet packet;
+	packet << static_cast<sf::Uint8>(PacketID::ClientDisconnect);
+	mSocket.send(packet, mServerAddress, mServerPort);
+}
+
+void GameClient::update(sf::Time dt, ActionBits actions)
+{
+	mClock += dt;
+	receivePackets();
+
+	// Hellos may be lost like any datagram, so they are repeated until the welcome arrives
+	if (!mConnected)
+	{
+		if (!mServerFull && mClock - mLastHello >= sf::seconds(0.5f))
+		{
+			sf::Packet packet;
+			packet << static_cast<sf::Uint8>(PacketID::ClientHello) << ProtocolVersion;
+			mSocket.send(packet, mServerAddress, mServerPort);
+			mLastHello = mClock;
+		}
+		return;
+	}
+
+	if (!mStarted)
+		return;
+
+	// Stay InputLead ticks ahead of the server: too far ahead waits a tick, falling behind runs an extra one
+	if (mInputLead > 2 * InputLead)
+	{
+		--mInputLead;
+		return;
+	}
+
+	step(dt, actions);
+
+	if (mInputLead < InputLead / 2)
+	{
+		step(dt, actions & ~OneShotActions);
+		++mInputLead;
+	}
+}
+
+bool GameClient::isConnected() const
+{
+	return mConnected;
+}
+
+bool GameClient::hasStarted() const
+{
+	return mStarted;
+}
+
+bool GameClient::hasTimedOut() const
+{
+	return mClock - mLastHeard > sf::seconds(ConnectionTimeout);
+}
+
+bool GameClient::isServerFull() const
+{
+	return mServerFull;
+}
+
+std::size_t GameClient::getSlot() const
+{
+	return mSlot;
+}
+
+sf::Uint32 GameClient::getTick() const
+{
+	return mTick;
+}
+
+sf::Vector2f GameClient::getLastCorrection() const
+{
+	return mLastCorrection;
+}
+
+std::size_t GameClient::getReceivedBytes() const
+{
+	return mReceivedBytes;
+}
+
+void GameClient::receivePackets()
+{
+	sf::Packet packet;
+	sf::IpAddress address;
+	unsigned short port;
+
+	while (mSocket.receive(packet, address, port) == sf::Socket::Done)
+	{
+		if (address != mServerAddress || port != mServerPort)
+			continue;
+
+		mLastHeard = mClock;
+		mReceivedBytes += packet.getDataSize();
+		handlePacket(packet);
+	}
+}
+
+void GameClient::handlePacket(sf::Packet& packet)
+{
+	sf::Uint8 id;
+	if (!(packet >> id))
+		return;
+
+	switch (static_cast<PacketID>(id))
+	{
+	case PacketID::ServerWelcome:
+	{
+		sf::Uint8 slot;
+		if (packet >> slot && slot < MaxClients)
+		{
+			mSlot = slot;
+			mConnected = true;
+		}
+		break;
+	}
+
+	case PacketID::ServerFull:
+		mServerFull = true;
+		break;
+
+	case PacketID::ServerSnapshot:
+		if (mConnected)
+			handleSnapshot(packet);
+		break;
+
+	default:
+		// Client and rollback packets are never meant for a client; ignore them like any stray datagram
+		break;
+	}
+}
+
+void GameClient::handleSnapshot(sf::Packet& packet)
+{
+	sf::Int32 inputLead;
+	WorldSnapshot snapshot;
+	if (!(packet >> inputLead) || !readSnapshot(packet, snapshot, mSnapshotHistory))
+		return;
+
+	// Datagrams may arrive out of order; an older snapshot brings nothing new
+	if (!mSnapshotHistory.empty() && snapshot.tick <= mSnapshotHistory.back().tick)
+		return;
+
+	mInputLead = inputLead;
+	mSnapshotHistory.push_back(snapshot);
+	if (mSnapshotHistory.size() > SnapshotHistorySize)
+		mSnapshotHistory.pop_front();
+
+	if (mStarted)
+	{
+		reconcile(snapshot);
+	}
+	else
+	{
+		start(snapshot);
+		mStarted = true;
+	}
+}
+
+void GameClient::start(const WorldSnapshot& snapshot)
+{
+	// The world scrolls the same on both ends, so the fresh replica is brought to the same tick before taking the state
+	mTick = snapshot.tick + InputLead;
+	for (sf::Uint32 tick = 0; tick < mTick; ++tick)
+		mWorld.update(Application::TimePerFrame);
+
+	// Our aircraft was fast-forwarded with the world; should it still be off, the first reconciliation moves it
+	mStartTick = mTick;
+	mPredictedIdentifier = getPredictedIdentifier(snapshot);
+	mWorld.applySnapshot(snapshot, mPredictedIdentifier, Application::TimePerFrame * static_cast<sf::Int64>(InputLead));
+}
+
+void GameClient::reconcile(const WorldSnapshot& snapshot)
+{
+	sf::Int64 ticksAhead = mTick > snapshot.tick ? mTick - snapshot.tick : 0;
+	mWorld.applySnapshot(snapshot, mPredictedIdentifier, Application::TimePerFrame * ticksAhead);
+
+	// The snapshot holds the state after the server applied the input of tick - 1; compare with our prediction for it
+	const AircraftSnapshot* state = findAircraft(snapshot, mPredictedIdentifier);
+	Aircraft* aircraft = mWorld.getAircraft(mPredictedIdentifier);
+	if (!state || !aircraft || aircraft->isDestroyed() || snapshot.tick <= mStartTick)
+		return;
+
+	sf::Uint32 predictedTick = snapshot.tick - 1;
+	if (predictedTick >= mTick || mTick - predictedTick > PredictionBufferSize)
+		return;
+
+	// Movement is a sum of per-tick steps, so an error at that tick carries unchanged into every later prediction
+	// Snapshot positions are rounded to SnapshotPrecision; errors within the rounding are not worth a correction
+	sf::Vector2f error = state->position - mPredictions[predictedTick % PredictionBufferSize];
+	if (std::abs(error.x) <= SnapshotPrecision && std::abs(error.y) <= SnapshotPrecision)
+		error = sf::Vector2f();
+
+	mLastCorrection = error;
+	if (error == sf::Vector2f())
+		return;
+
+	aircraft->move(error);
+	for (sf::Uint32 tick = predictedTick; tick < mTick; ++tick)
+		mPredictions[tick % PredictionBufferSize] += error;
+}
+
+void GameClient::sendInput()
+{
+	// The newest inputs, oldest first; each is resent InputRedundancy times before it drops out
+	sf::Uint32 count = std::min<sf::Uint32>(InputRedundancy, mTick - mStartTick + 1);
+
+	sf::Packet packet;
+	packet << static_cast<sf::Uint8>(PacketID::ClientInput)
+		<< (mSnapshotHistory.empty() ? NoSnapshot : mSnapshotHistory.back().tick)
+		<< mTick << static_cast<sf::Uint8>(count);
+
+	for (sf::Uint32 tick = mTick + 1 - count; tick <= mTick; ++tick)
+		packet << mInputs[tick % PredictionBufferSize];
+
+	mSocket.send(packet, mServerAddress, mServerPort);
+}
+
+void GameClient::step(sf::Time dt, ActionBits actions)
+{
+	std::size_t index = mTick % PredictionBufferSize;
+	mInputs[index] = actions;
+	sendInput();
+
+	CommandQueue& commands = mWorld.getCommandQueue();
+	if (mSlot == 0)
+		mPlayer.applyActions(actions, commands);
+	else
+		mPlayer2.applyActions(actions, commands);
+
+	mWorld.update(dt);
+
+	if (Aircraft* aircraft = mWorld.getAircraft(mPredictedIdentifier))
+		mPredictions[index] = aircraft->getPosition();
+
+	++mTick;
+}
+
+unsigned int GameClient::getPredictedIdentifier(const WorldSnapshot& snapshot) const
+{
+	AircraftID type = (mSlot == 0) ? AircraftID::Player : AircraftID::Player2;
+	for (const AircraftSnapshot& aircraft : snapshot.aircraft)
+	{
+		if (aircraft.type == type)
+			return aircraft.identifier;
+	}
+
+	return 0;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include "Player.hpp"
+#include "Player2.hpp"
+#include "WorldSnapshot.hpp"
+#include "NetworkProtocol.hpp"
+
+#include <SFML/Network/UdpSocket.hpp>
+#include <SFML/Network/IpAddress.hpp>
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
+
+#include <array>
+#include <deque>
+
+class World;
+
+namespace sf
+{
+	class Packet;
+}
+
+//Client of a GameServer: predicts the local aircraft in a replica World and reconciles it with the server's snapshots
+class GameClient : private sf::NonCopyable
+{
+public:
+	GameClient(World& world, const sf::IpAddress& server, unsigned short port);
+	~GameClient();
+
+	//One fixed tick: receive, then (once the mission started) send and apply the local input and step the world
+	void update(sf::Time dt, ActionBits actions);
+
+	bool isConnected() const;
+	bool hasStarted() const;
+	bool hasTimedOut() const;
+	bool isServerFull() const;
+
+	std::size_t getSlot() const;
+	sf::Uint32 getTick() const;
+	//Distance the local aircraft was moved by the last reconciliation
+	sf::Vector2f getLastCorrection() const;
+	std::size_t getReceivedBytes() const;
+
+private:
+	static const std::size_t PredictionBufferSize = 64;
+
+private:
+	void receivePackets();
+	void handlePacket(sf::Packet& packet);
+	void handleSnapshot(sf::Packet& packet);
+	void start(const WorldSnapshot& snapshot);
+	void reconcile(const WorldSnapshot& snapshot);
+	void sendInput();
+	void step(sf::Time dt, ActionBits actions);
+	unsigned int getPredictedIdentifier(const WorldSnapshot& snapshot) const;
+
+private:
+	World& mWorld;
+	Player mPlayer;
+	Player2 mPlayer2;
+
+	sf::UdpSocket mSocket;
+	sf::IpAddress mServerAddress;
+	unsigned short mServerPort;
+	sf::Time mClock;
+	sf::Time mLastHeard;
+	sf::Time mLastHello;
+
+	bool mConnected;
+	bool mStarted;
+	bool mServerFull;
+	std::size_t mSlot;
+	sf::Uint32 mTick;
+	sf::Uint32 mStartTick;
+	sf::Int32 mInputLead;
+
+	// Local input and predicted position by tick, tick % PredictionBufferSize
+	std::array<ActionBits, PredictionBufferSize> mInputs;
+	std::array<sf::Vector2f, PredictionBufferSize> mPredictions;
+
+	std::deque<WorldSnapshot> mSnapshotHistory;
+	unsigned int mPredictedIdentifier;
+	sf::Vector2f mLastCorrection;
+	std::size_t mReceivedBytes;
+};
@@ -0,0 +1,334 @@
+#include "GameServer.hpp"
+#include "PacketID.hpp"
+#include "Application.hpp"
+
+#include <SFML/Network/Packet.hpp>
+
+#include <algorithm>
+
+GameServer::Peer::Peer()
+	: connected(false)
+	, address()
+	, port(0)
+	, lastHeard()
+	, inputs()
+	, inputTicks()
+	, newestInput(0)
+	, lastActions(0)
+	, ackedSnapshot(NoSnapshot)
+	, interest(DefaultBytesPerTick * SnapshotInterval)
+	, history()
+{
+	inputTicks.fill(NoSnapshot);
+}
+
+GameServer::GameServer(unsigned short port, sf::Vector2f viewSize)
+	: mSocket()
+	, mListening(false)
+	, mViewSize(viewSize)
+	, mWorld()
+	, mPlayer()
+	, mPlayer2()
+	, mPeers()
+	, mClock()
+	, mAccumulator()
+	, mTick(0)
+	, mStarted(false)
+	, mSnapshot()
+	, mView()
+	, mBytesPerTick(DefaultBytesPerTick)
+	, mSentBytes(0)
+{
+	mListening = mSocket.bind(port) == sf::Socket::Done;
+	mSocket.setBlocking(false);
+
+	resetWorld();
+}
+
+bool GameServer::isListening() const
+{
+	return mListening;
+}
+
+void GameServer::update(sf::Time dt)
+{
+	mClock += dt;
+	receivePackets();
+	dropIdlePeers();
+
+	// The mission starts once both seats are taken; tick 0 goes out at once, clients start on their first snapshot
+	if (!mStarted)
+	{
+		if (getPeerCount() < MaxClients)
+			return;
+
+		mStarted = true;
+		mAccumulator = sf::Time::Zero;
+		broadcastSnapshot();
+	}
+
+	mAccumulator += dt;
+	while (mAccumulator >= Application::TimePerFrame)
+	{
+		mAccumulator -= Application::TimePerFrame;
+		tick();
+	}
+}
+
+void GameServer::setBytesPerTick(std::size_t bytesPerTick)
+{
+	mBytesPerTick = bytesPerTick;
+
+	for (Peer& peer : mPeers)
+		peer.interest.setByteBudget(mBytesPerTick * SnapshotInterval);
+}
+
+sf::Uint32 GameServer::getTick() const
+{
+	return mTick;
+}
+
+std::size_t GameServer::getPeerCount() const
+{
+	return std::count_if(mPeers.begin(), mPeers.end(), [](const Peer& peer) { return peer.connected; });
+}
+
+std::size_t GameServer::getSentBytes() const
+{
+	return mSentBytes;
+}
+
+std::size_t GameServer::getDeferredCount() const
+{
+	std::size_t deferred = 0;
+	for (const Peer& peer : mPeers)
+	{
+		if (peer.connected)
+			deferred += peer.interest.getDeferredCount();
+	}
+
+	return deferred;
+}
+
+void GameServer::receivePackets()
+{
+	sf::Packet packet;
+	sf::IpAddress address;
+	unsigned short port;
+
+	while (mSocket.receive(packet, address, port) == sf::Socket::Done)
+		handlePacket(packet, address, port);
+}
+
+void GameServer::handlePacket(sf::Packet& packet, const sf::IpAddress& address, unsigned short port)
+{
+	sf::Uint8 id;
+	if (!(packet >> id))
+		return;
+
+	if (static_cast<PacketID>(id) == PacketID::ClientHello)
+	{
+		sf::Uint32 version;
+		if (packet >> version && version == ProtocolVersion)
+			handleHello(address, port);
+		return;
+	}
+
+	// Everything else is only accepted from a seated client
+	Peer* peer = findPeer(address, port);
+	if (!peer)
+		return;
+
+	peer->lastHeard = mClock;
+
+	switch (static_cast<PacketID>(id))
+	{
+	case PacketID::ClientInput:
+		handleInput(packet, *peer);
+		break;
+
+	case PacketID::ClientDisconnect:
+		*peer = Peer();
+		break;
+
+	default:
+		// Server and rollback packets are never meant for a server; ignore them like any stray datagram
+		break;
+	}
+}
+
+void GameServer::handleHello(const sf::IpAddress& address, unsigned short port)
+{
+	// Hellos are resent until the welcome arrives, so a seated client is simply welcomed again
+	Peer* peer = findPeer(address, port);
+	if (!peer)
+	{
+		auto free = std::find_if(mPeers.begin(), mPeers.end(), [](const Peer& p) { return !p.connected; });
+		if (free != mPeers.end())
+		{
+			*free = Peer();
+			free->connected = true;
+			free->address = address;
+			free->port = port;
+			free->newestInput = mTick;
+			free->interest.setByteBudget(mBytesPerTick * SnapshotInterval);
+			peer = &*free;
+		}
+	}
+
+	sf::Packet packet;
+	if (peer)
+	{
+		peer->lastHeard = mClock;
+		packet << static_cast<sf::Uint8>(PacketID::ServerWelcome) << static_cast<sf::Uint8>(peer - mPeers.data());
+	}
+	else
+	{
+		packet << static_cast<sf::Uint8>(PacketID::ServerFull);
+	}
+
+	mSentBytes += packet.getDataSize();
+	mSocket.send(packet, address, port);
+}
+
+void GameServer::handleInput(sf::Packet& packet, Peer& peer)
+{
+	sf::Uint32 ackedSnapshot, newestInput;
+	sf::Uint8 count;
+	if (!(packet >> ackedSnapshot >> newestInput >> count) || count > newestInput + 1)
+		return;
+
+	if (ackedSnapshot != NoSnapshot && (peer.ackedSnapshot == NoSnapshot || ackedSnapshot > peer.ackedSnapshot))
+		peer.ackedSnapshot = ackedSnapshot;
+
+	// Oldest first; inputs for ticks already simulated, or too far ahead to buffer, are dropped
+	for (sf::Uint32 inputTick = newestInput + 1 - count; inputTick <= newestInput; ++inputTick)
+	{
+		sf::Uint8 actions;
+		if (!(packet >> actions))
+			return;
+
+		if (inputTick < mTick || inputTick >= mTick + InputBufferSize)
+			continue;
+
+		peer.inputs[inputTick % InputBufferSize] = actions;
+		peer.inputTicks[inputTick % InputBufferSize] = inputTick;
+	}
+
+	peer.newestInput = std::max(peer.newestInput, newestInput);
+}
+
+GameServer::Peer* GameServer::findPeer(const sf::IpAddress& address, unsigned short port)
+{
+	for (Peer& peer : mPeers)
+	{
+		if (peer.connected && peer.address == address && peer.port == port)
+			return &peer;
+	}
+
+	return nullptr;
+}
+
+void GameServer::tick()
+{
+	// After the mission ends the final state keeps going out, for clients that lost the snapshot showing it
+	if (!hasMissionEnded())
+	{
+		CommandQueue& commands = mWorld->getCommandQueue();
+		mPlayer.applyActions(consumeInput(mPeers[0]), commands);
+		mPlayer2.applyActions(consumeInput(mPeers[1]), commands);
+
+		mWorld->update(Application::TimePerFrame);
+	}
+
+	++mTick;
+	if (mTick % SnapshotInterval == 0)
+		broadcastSnapshot();
+}
+
+ActionBits GameServer::consumeInput(Peer& peer)
+{
+	std::size_t slot = mTick % InputBufferSize;
+	if (peer.inputTicks[slot] == mTick)
+	{
+		peer.inputTicks[slot] = NoSnapshot;
+		peer.lastActions = peer.inputs[slot];
+		return peer.lastActions;
+	}
+
+	// Late or lost: assume held keys are still held; the client's reconciliation corrects any difference
+	return peer.lastActions & ~OneShotActions;
+}
+
+void GameServer::broadcastSnapshot()
+{
+	mWorld->captureSnapshot(mSnapshot);
+	mSnapshot.tick = mTick;
+
+	sf::FloatRect relevanceBounds = mWorld->getBattlefieldBounds();
+
+	for (std::size_t slot = 0; slot < mPeers.size(); ++slot)
+	{
+		Peer& peer = mPeers[slot];
+		if (!peer.connected)
+			continue;
+
+		// Delta against the newest snapshot the client acknowledged; one the server no longer has means a full snapshot
+		auto baseline = std::find_if(peer.history.begin(), peer.history.end(), [&](const WorldSnapshot& s)
+		{
+			return s.tick == peer.ackedSnapshot;
+		});
+		const WorldSnapshot* baselineSnapshot = baseline != peer.history.end() ? &*baseline : nullptr;
+
+		// Interest is centred on the client's own aircraft, or the battlefield once it is gone
+		AircraftID type = (slot == 0) ? AircraftID::Player : AircraftID::Player2;
+		sf::Vector2f focus(relevanceBounds.left + relevanceBounds.width / 2.f, relevanceBounds.top + relevanceBounds.height / 2.f);
+		for (const AircraftSnapshot& aircraft : mSnapshot.aircraft)
+		{
+			if (aircraft.type == type)
+				focus = aircraft.position;
+		}
+
+		peer.interest.filter(mSnapshot, baselineSnapshot, relevanceBounds, focus, mView);
+
+		// Tells the client how far ahead of the server its input arrives, so it can keep InputLead
+		sf::Int32 inputLead = static_cast<sf::Int32>(peer.newestInput - mTick);
+
+		sf::Packet packet;
+		packet << static_cast<sf::Uint8>(PacketID::ServerSnapshot) << inputLead;
+		writeSnapshot(packet, mView, baselineSnapshot);
+
+		mSentBytes += packet.getDataSize();
+		mSocket.send(packet, peer.address, peer.port);
+
+		peer.history.push_back(mView);
+		if (peer.history.size() > SnapshotHistorySize)
+			peer.history.pop_front();
+	}
+}
+
+void GameServer::dropIdlePeers()
+{
+	for (Peer& peer : mPeers)
+	{
+		if (peer.connected && mClock - peer.lastHeard > sf::seconds(ConnectionTimeout))
+			peer = Peer();
+	}
+
+	// Everyone left: the next two clients get a fresh mission
+	if (mStarted && getPeerCount() == 0)
+		resetWorld();
+}
+
+void GameServer::resetWorld()
+{
+	mWorld.reset(new World(mViewSize));
+
+	mTick = 0;
+	mStarted = false;
+}
+
+bool GameServer::hasMissionEnded() const
+{
+	return !mWorld->hasAlivePlayer() || !mWorld->hasAlivePlayer2() || mWorld->hasPlayerReachedEnd() || mWorld->hasPlayer2ReachedEnd();
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include "World.hpp"
+#include "Player.hpp"
+#include "Player2.hpp"
+#include "WorldSnapshot.hpp"
+#include "InterestSet.hpp"
+#include "NetworkProtocol.hpp"
+
+#include <SFML/Network/UdpSocket.hpp>
+#include <SFML/Network/IpAddress.hpp>
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
+
+#include <array>
+#include <deque>
+#include <memory>
+
+namespace sf
+{
+	class Packet;
+}
+
+//Authoritative two-player server: simulates a headless World on the fixed tick and sends each client delta snapshots
+class GameServer : private sf::NonCopyable
+{
+public:
+	GameServer(unsigned short port, sf::Vector2f viewSize);
+
+	bool isListening() const;
+	//Receives pending datagrams, then advances the world by as many fixed ticks as dt covers
+	void update(sf::Time dt);
+
+	//Caps each client's snapshots; entities over budget are refreshed in later snapshots
+	void setBytesPerTick(std::size_t bytesPerTick);
+
+	sf::Uint32 getTick() const;
+	std::size_t getPeerCount() const;
+	std::size_t getSentBytes() const;
+	//Relevant entities left stale in the last snapshots, summed over clients
+	std::size_t getDeferredCount() const;
+
+private:
+	static const std::size_t InputBufferSize = 64;
+
+	struct Peer
+	{
+		Peer();
+
+		bool connected;
+		sf::IpAddress address;
+		unsigned short port;
+		sf::Time lastHeard;
+
+		// Inputs by tick, sequence % InputBufferSize
+		std::array<ActionBits, InputBufferSize> inputs;
+		std::array<sf::Uint32, InputBufferSize> inputTicks;
+		sf::Uint32 newestInput;
+		ActionBits lastActions;
+		sf::Uint32 ackedSnapshot;
+
+		// Each client gets its own view of the world, so deltas are against what that client was sent
+		InterestSet interest;
+		std::deque<WorldSnapshot> history;
+	};
+
+private:
+	void receivePackets();
+	void handlePacket(sf::Packet& packet, const sf::IpAddress& address, unsigned short port);
+	void handleHello(const sf::IpAddress& address, unsigned short port);
+	void handleInput(sf::Packet& packet, Peer& peer);
+	Peer* findPeer(const sf::IpAddress& address, unsigned short port);
+
+	void tick();
+	ActionBits consumeInput(Peer& peer);
+	void broadcastSnapshot();
+	void dropIdlePeers();
+	void resetWorld();
+	bool hasMissionEnded() const;
+
+private:
+	sf::UdpSocket mSocket;
+	bool mListening;
+	sf::Vector2f mViewSize;
+	std::unique_ptr<World> mWorld;
+	Player mPlayer;
+	Player2 mPlayer2;
+
+	std::array<Peer, MaxClients> mPeers;
+	sf::Time mClock;
+	sf::Time mAccumulator;
+	sf::Uint32 mTick;
+	bool mStarted;
+
+	WorldSnapshot mSnapshot;
+	WorldSnapshot mView;
+	std::size_t mBytesPerTick;
+	std::size_t mSentBytes;
+};
@@ -1,25 +1,66 @@
 //Eoghan - D00187992
 
 #include "GameState.hpp"
+#include "Utility.hpp"
+
+namespace
+{
+	const std::string ReplayFile = "LastMission.replay";
+}
 
 GameState::GameState(StateStack& stack, Context context)
 	:State(stack, context)
 	, mWorld(*context.window, *context.fonts, *context.sounds)
 	, mPlayer(*context.player)
 	, mPlayer2(*context.player2)
+	, mReplay()
+	, mInput(*context.player, *context.player2)
+	, mProfiler(context.profiler)
 {
+	//Nothing random happens before the first update, so seeding here covers the whole mission
+	unsigned int seed = createRandomSeed();
+	seedRandomEngine(seed);
+	mReplay.startRecording(seed);
+
+	mWorld.setProfiler(context.profiler);
+	mWorld.setWorkerThreads(JobSystem::getDefaultWorkerCount());
+	mWorld.setRenderThread(context.renderThread);
+
 	mPlayer.setMissionStatus(MissionStatusID::MissionRunning);
 	mPlayer2.setMissionStatus(MissionStatusID::MissionRunning);
 	context.music->play(MusicID::MissionTheme);
 }
 
+GameState::~GameState()
+{
+	//Keep the last mission around, "--replay LastMission.replay" re-simulates it
+	mReplay.saveToFile(ReplayFile);
+}
+
 void GameState::draw()
 {
-	mWorld.draw();
+	mWorld.draw(getInterpolation());
 }
 
 bool GameState::update(sf::Time dt)
 {
+	//Take both players' input sampled since the last tick; the same bits go to the world and to the replay
+	ActionBits player1;
+	ActionBits player2;
+	mInput.consume(player1, player2);
+	mReplay.record(player1, player2);
+
+	if (mProfiler)
+	{
+		mProfiler->setCounter("Input latency avg (us)", static_cast<std::size_t>(mInput.getAverageLatency().asMicroseconds()));
+		mProfiler->setCounter("Input latency max (us)", static_cast<std::size_t>(mInput.getMaxLatency().asMicroseconds()));
+		mProfiler->setCounter("Input queue overflows", mInput.getOverflowCount());
+	}
+
+	CommandQueue& commands = mWorld.getCommandQueue();
+	mPlayer.applyActions(player1, commands);
+	mPlayer2.applyActions(player2, commands);
+
 	mWorld.update(dt);
 
 	if (!mWorld.hasAlivePlayer())
@@ -44,10 +85,6 @@ bool GameState::update(sf::Time dt)
 		requestStackPush(StateID::GameOver);
 	}
 
-	CommandQueue& commands = mWorld.getCommandQueue();
-	mPlayer.handleRealtimeInput(commands);
-	mPlayer2.handleRealtimeInput(commands);
-
 	return true;
 }
 
@@ -55,10 +92,7 @@ bool GameState::update(sf::Time dt)
 
 bool GameState::handleEvent(const sf::Event& event)
 {
-	CommandQueue& commands = mWorld.getCommandQueue();
-	mPlayer.handleEvent(event, commands);
-	mPlayer2.handleEvent(event, commands);
-
+	//Key presses reach the players through the input thread, events only drive the menus
 	//Pause if esc is pressed
 	if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape)
 	{
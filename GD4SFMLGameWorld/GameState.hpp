@@ -4,6 +4,8 @@
 #include "World.hpp"
 #include "Player.hpp"
 #include "Player2.hpp"
+#include "Replay.hpp"
+#include "InputThread.hpp"
 #include <SFML/Graphics/Sprite.hpp>
 #include <SFML/Graphics/Text.hpp>
 
@@ -11,6 +13,7 @@ class GameState : public State
 {
 public:
 	GameState(StateStack& stack, Context context);
+	virtual ~GameState();
 
 	virtual void draw();
 	virtual bool update(sf::Time dt);
@@ -20,4 +23,7 @@ private:
 	World mWorld;
 	Player& mPlayer;
 	Player2& mPlayer2;
+	Replay mReplay;
+	InputThread mInput;
+	Profiler* mProfiler;
 };
\ No newline at end of file
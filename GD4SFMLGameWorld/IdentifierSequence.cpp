@@ -0,0 +1,21 @@
+#include "IdentifierSequence.hpp"
+
+IdentifierSequence::IdentifierSequence()
+	: mLast(0)
+{
+}
+
+unsigned int IdentifierSequence::allocate()
+{
+	return ++mLast;
+}
+
+unsigned int IdentifierSequence::getLast() const
+{
+	return mLast;
+}
+
+void IdentifierSequence::setLast(unsigned int identifier)
+{
+	mLast = identifier;
+}
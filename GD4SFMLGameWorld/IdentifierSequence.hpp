@@ -0,0 +1,18 @@
+#pragma once
+#include <SFML/System/NonCopyable.hpp>
+
+//Hands out the identifiers that name entities and bullets in network snapshots
+//Each World owns one, so two worlds in one process (a server and a bot, or a rollback resimulation) never share a counter
+class IdentifierSequence : private sf::NonCopyable
+{
+public:
+	IdentifierSequence();
+
+	unsigned int allocate();
+	//Restoring a saved world rewinds the sequence too, so resimulated entities get the same identifiers again
+	unsigned int getLast() const;
+	void setLast(unsigned int identifier);
+
+private:
+	unsigned int mLast;
+};
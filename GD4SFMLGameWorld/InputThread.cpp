@@ -0,0 +1,150 @@
+#include "InputThread.hpp"
+#include "Player.hpp"
+#include "Player2.hpp"
+
+#include <SFML/System/Sleep.hpp>
+
+#include <algorithm>
+
+namespace
+{
+	// Nothing waits this long while the game runs, only while it is paused
+	const sf::Time StaleSampleAge = sf::milliseconds(100);
+}
+
+InputThread::InputThread(const Player& player, const Player2& player2, sf::Time interval)
+	: mKeys1()
+	, mKeys2()
+	, mOneShotActions(0)
+	, mInterval(interval)
+	, mClock()
+	, mQueue()
+	, mRunning(true)
+	, mOverflows(0)
+	, mHeld1(0)
+	, mHeld2(0)
+	, mLatencySamples(0)
+	, mLatencyTotal()
+	, mLatencyMax()
+	, mStaleSamples(0)
+	, mThread(&InputThread::run, this)
+{
+	for (std::size_t i = 0; i < mKeys1.size(); ++i)
+	{
+		ActionID action = static_cast<ActionID>(i);
+		mKeys1[i] = player.getAssignedKey(action);
+		mKeys2[i] = player2.getAssignedKey(action);
+
+		if (!Player::isRealtimeAction(action))
+			mOneShotActions |= 1 << i;
+	}
+
+	mThread.launch();
+}
+
+InputThread::~InputThread()
+{
+	mRunning = false;
+	mThread.wait();
+}
+
+void InputThread::consume(ActionBits& player1, ActionBits& player2)
+{
+	// Keys held at the last tick are still held unless a sample says otherwise
+	ActionBits actions1 = mHeld1 & ~mOneShotActions;
+	ActionBits actions2 = mHeld2 & ~mOneShotActions;
+	sf::Time now = mClock.getElapsedTime();
+
+	Sample sample;
+	while (mQueue.pop(sample))
+	{
+		sf::Time latency = now - sample.time;
+		if (latency > StaleSampleAge)
+		{
+			// Keys pressed behind a pause menu only update what is held, they do not fire
+			++mStaleSamples;
+		}
+		else
+		{
+			// A key pressed and released between two ticks still counts for the later one
+			actions1 |= (sample.player1 & ~mOneShotActions) | (sample.player1 & ~mHeld1 & mOneShotActions);
+			actions2 |= (sample.player2 & ~mOneShotActions) | (sample.player2 & ~mHeld2 & mOneShotActions);
+
+			++mLatencySamples;
+			mLatencyTotal += latency;
+			mLatencyMax = std::max(mLatencyMax, latency);
+		}
+
+		mHeld1 = sample.player1;
+		mHeld2 = sample.player2;
+	}
+
+	player1 = actions1 | (mHeld1 & ~mOneShotActions);
+	player2 = actions2 | (mHeld2 & ~mOneShotActions);
+}
+
+std::size_t InputThread::getLatencySampleCount() const
+{
+	return mLatencySamples;
+}
+
+sf::Time InputThread::getAverageLatency() const
+{
+	if (mLatencySamples == 0)
+		return sf::Time::Zero;
+
+	return mLatencyTotal / static_cast<sf::Int64>(mLatencySamples);
+}
+
+sf::Time InputThread::getMaxLatency() const
+{
+	return mLatencyMax;
+}
+
+std::size_t InputThread::getStaleSampleCount() const
+{
+	return mStaleSamples;
+}
+
+std::size_t InputThread::getOverflowCount() const
+{
+	return mOverflows;
+}
+
+void InputThread::run()
+{
+	ActionBits last1 = 0;
+	ActionBits last2 = 0;
+
+	while (mRunning)
+	{
+		// Only changes are queued; the consumer keeps the held state in between
+		Sample sample = { sampleKeys(mKeys1), sampleKeys(mKeys2), mClock.getElapsedTime() };
+		if (sample.player1 != last1 || sample.player2 != last2)
+		{
+			if (mQueue.push(sample))
+			{
+				last1 = sample.player1;
+				last2 = sample.player2;
+			}
+			else
+			{
+				++mOverflows;
+			}
+		}
+
+		sf::sleep(mInterval);
+	}
+}
+
+ActionBits InputThread::sampleKeys(const KeyBinding& keys)
+{
+	ActionBits actions = 0;
+	for (std::size_t i = 0; i < keys.size(); ++i)
+	{
+		if (keys[i] != sf::Keyboard::Unknown && sf::Keyboard::isKeyPressed(keys[i]))
+			actions |= 1 << i;
+	}
+
+	return actions;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "ActionID.hpp"
+#include "SpscQueue.hpp"
+
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Thread.hpp>
+#include <SFML/System/Time.hpp>
+#include <SFML/Window/Keyboard.hpp>
+
+#include <array>
+#include <atomic>
+
+class Player;
+class Player2;
+
+//Samples both players' keys on its own thread and queues every change with the time it was seen,
+//so input is not lost or delayed while the main thread is busy drawing
+class InputThread : private sf::NonCopyable
+{
+public:
+	//Key bindings are copied, they cannot change while the thread runs
+	InputThread(const Player& player, const Player2& player2, sf::Time interval = sf::milliseconds(1));
+	~InputThread();
+
+	//Once per tick on the simulation thread: every action held since the last tick, one-shot actions only when newly pressed
+	void consume(ActionBits& player1, ActionBits& player2);
+
+	//Time from a key change being sampled to the tick that consumed it
+	std::size_t getLatencySampleCount() const;
+	sf::Time getAverageLatency() const;
+	sf::Time getMaxLatency() const;
+	//Changes that waited so long the game must have been paused
+	std::size_t getStaleSampleCount() const;
+	//Samples that found the queue full and were retried
+	std::size_t getOverflowCount() const;
+
+private:
+	typedef std::array<sf::Keyboard::Key, static_cast<std::size_t>(ActionID::ActionCount)> KeyBinding;
+
+	struct Sample
+	{
+		ActionBits player1;
+		ActionBits player2;
+		sf::Time time;
+	};
+
+	static const std::size_t QueueCapacity = 256;
+
+private:
+	void run();
+	static ActionBits sampleKeys(const KeyBinding& keys);
+
+private:
+	KeyBinding mKeys1;
+	KeyBinding mKeys2;
+	ActionBits mOneShotActions;
+	sf::Time mInterval;
+
+	// Started before the thread; both threads only read it
+	sf::Clock mClock;
+	SpscQueue<Sample, QueueCapacity> mQueue;
+	std::atomic<bool> mRunning;
+	std::atomic<std::size_t> mOverflows;
+
+	// Consumer side only
+	ActionBits mHeld1;
+	ActionBits mHeld2;
+	std::size_t mLatencySamples;
+	sf::Time mLatencyTotal;
+	sf::Time mLatencyMax;
+	std::size_t mStaleSamples;
+
+	// Declared last, so everything it uses exists before it is launched
+	sf::Thread mThread;
+};
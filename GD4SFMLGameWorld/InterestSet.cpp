@@ -0,0 +1,197 @@
+#include "InterestSet.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	// Priority halves at this distance from the client's aircraft
+	const float PriorityDistance = 256.f;
+
+	// Tick, baseline tick, spawn cursor and the six list counts, rounded up
+	const std::size_t HeaderBits = 128;
+
+	const float Mandatory = std::numeric_limits<float>::max();
+
+	// Category weights: what can hit the player first, what the player shoots at next
+	float categoryWeight(const AircraftSnapshot& aircraft)
+	{
+		return (aircraft.type == AircraftID::Player || aircraft.type == AircraftID::Player2) ? Mandatory : 3.f;
+	}
+
+	float categoryWeight(const ProjectileSnapshot& projectile)
+	{
+		switch (projectile.type)
+		{
+		case ProjectileID::EnemyBullet:
+			return 4.f;
+		case ProjectileID::Missile:
+			return 2.f;
+		default:
+			return 1.f;
+		}
+	}
+
+	float categoryWeight(const PickupSnapshot&)
+	{
+		return 2.f;
+	}
+
+	template <typename Entry>
+	std::size_t findIndex(const std::vector<Entry>& entries, unsigned int identifier)
+	{
+		auto found = std::lower_bound(entries.begin(), entries.end(), identifier,
+			[](const Entry& e, unsigned int id) { return e.identifier < id; });
+
+		if (found == entries.end() || found->identifier != identifier)
+			return static_cast<std::size_t>(-1);
+
+		return found - entries.begin();
+	}
+}
+
+InterestSet::InterestSet(std::size_t byteBudget)
+	: mByteBudget(byteBudget)
+	, mBitsLeft(0)
+	, mCandidates()
+	, mAccumulated()
+	, mRound(0)
+	, mRelevantCount(0)
+	, mDeferredCount(0)
+{
+}
+
+void InterestSet::setByteBudget(std::size_t byteBudget)
+{
+	mByteBudget = byteBudget;
+}
+
+void InterestSet::filter(const WorldSnapshot& world, const WorldSnapshot* baseline, const sf::FloatRect& relevanceBounds, sf::Vector2f focus, WorldSnapshot& view)
+{
+	++mRound;
+	mCandidates.clear();
+	mBitsLeft = mByteBudget * 8 > HeaderBits ? mByteBudget * 8 - HeaderBits : 0;
+
+	addCandidates(AircraftList, world.aircraft, baseline ? &baseline->aircraft : nullptr, relevanceBounds, focus);
+	addCandidates(ProjectileList, world.projectiles, baseline ? &baseline->projectiles : nullptr, relevanceBounds, focus);
+	addCandidates(PickupList, world.pickups, baseline ? &baseline->pickups : nullptr, relevanceBounds, focus);
+
+	// Forget entities that are gone or no longer relevant
+	for (auto itr = mAccumulated.begin(); itr != mAccumulated.end(); )
+	{
+		if (itr->second.round != mRound)
+			itr = mAccumulated.erase(itr);
+		else
+			++itr;
+	}
+
+	std::stable_sort(mCandidates.begin(), mCandidates.end(), [](const Candidate& lhs, const Candidate& rhs)
+	{
+		return lhs.priority > rhs.priority;
+	});
+
+	view.tick = world.tick;
+	view.spawnCursor = world.spawnCursor;
+	view.aircraft.clear();
+	view.projectiles.clear();
+	view.pickups.clear();
+
+	// Greedy by priority; a large entry that does not fit leaves room for smaller ones behind it
+	mRelevantCount = mCandidates.size();
+	mDeferredCount = 0;
+	for (const Candidate& candidate : mCandidates)
+	{
+		bool fresh = candidate.priority == Mandatory || candidate.bits <= mBitsLeft;
+		if (!fresh)
+		{
+			++mDeferredCount;
+		}
+		else if (candidate.priority != Mandatory)
+		{
+			mBitsLeft -= candidate.bits;
+			mAccumulated[candidate.identifier].priority = 0.f;
+		}
+
+		place(world, baseline, candidate, fresh, view);
+	}
+
+	auto byIdentifier = [](const auto& lhs, const auto& rhs) { return lhs.identifier < rhs.identifier; };
+	std::sort(view.aircraft.begin(), view.aircraft.end(), byIdentifier);
+	std::sort(view.projectiles.begin(), view.projectiles.end(), byIdentifier);
+	std::sort(view.pickups.begin(), view.pickups.end(), byIdentifier);
+}
+
+std::size_t InterestSet::getRelevantCount() const
+{
+	return mRelevantCount;
+}
+
+std::size_t InterestSet::getDeferredCount() const
+{
+	return mDeferredCount;
+}
+
+template <typename Entry>
+void InterestSet::addCandidates(ListID list, const std::vector<Entry>& entries, const std::vector<Entry>* previous, const sf::FloatRect& relevanceBounds, sf::Vector2f focus)
+{
+	for (std::size_t i = 0; i < entries.size(); ++i)
+	{
+		const Entry& entry = entries[i];
+		float weight = categoryWeight(entry);
+		if (weight != Mandatory && !relevanceBounds.contains(entry.position))
+			continue;
+
+		Candidate candidate;
+		candidate.list = list;
+		candidate.identifier = entry.identifier;
+		candidate.index = i;
+		candidate.previousIndex = previous ? findIndex(*previous, entry.identifier) : NotInBaseline;
+		candidate.bits = measureSnapshotEntry(entry, candidate.previousIndex != NotInBaseline ? &(*previous)[candidate.previousIndex] : nullptr);
+
+		// Unchanged entries cost nothing, mandatory ones are paid for up front
+		if (candidate.bits == 0 || weight == Mandatory)
+		{
+			candidate.priority = Mandatory;
+			mBitsLeft -= std::min(candidate.bits, mBitsLeft);
+			candidate.bits = 0;
+			mCandidates.push_back(candidate);
+			continue;
+		}
+
+		sf::Vector2f offset = entry.position - focus;
+		float distance = std::sqrt(offset.x * offset.x + offset.y * offset.y);
+
+		Accumulated& accumulated = mAccumulated[entry.identifier];
+		if (accumulated.round + 1 != mRound)
+			accumulated.priority = 0.f;
+
+		accumulated.priority += weight / (1.f + distance / PriorityDistance);
+		accumulated.round = mRound;
+
+		candidate.priority = accumulated.priority;
+		mCandidates.push_back(candidate);
+	}
+}
+
+void InterestSet::place(const WorldSnapshot& world, const WorldSnapshot* baseline, const Candidate& candidate, bool fresh, WorldSnapshot& view) const
+{
+	// A deferred entity keeps the state the client already has; one it has never seen waits for its turn
+	if (!fresh && candidate.previousIndex == NotInBaseline)
+		return;
+
+	switch (candidate.list)
+	{
+	case AircraftList:
+		view.aircraft.push_back(fresh ? world.aircraft[candidate.index] : baseline->aircraft[candidate.previousIndex]);
+		break;
+
+	case ProjectileList:
+		view.projectiles.push_back(fresh ? world.projectiles[candidate.index] : baseline->projectiles[candidate.previousIndex]);
+		break;
+
+	case PickupList:
+		view.pickups.push_back(fresh ? world.pickups[candidate.index] : baseline->pickups[candidate.previousIndex]);
+		break;
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "WorldSnapshot.hpp"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+//What one client hears about: the relevant part of a snapshot, refreshed by priority within a byte budget
+class InterestSet
+{
+public:
+	explicit InterestSet(std::size_t byteBudget);
+
+	//Bytes per snapshot
+	void setByteBudget(std::size_t byteBudget);
+
+	//Entities outside relevanceBounds are left out, so the client drops them. Both players are always refreshed;
+	//the rest go by category and distance to focus, and the ones over budget keep their baseline state, which costs nothing
+	void filter(const WorldSnapshot& world, const WorldSnapshot* baseline, const sf::FloatRect& relevanceBounds, sf::Vector2f focus, WorldSnapshot& view);
+
+	std::size_t getRelevantCount() const;
+	std::size_t getDeferredCount() const;
+
+private:
+	static const std::size_t NotInBaseline = static_cast<std::size_t>(-1);
+
+	enum ListID
+	{
+		AircraftList,
+		ProjectileList,
+		PickupList
+	};
+
+	struct Candidate
+	{
+		ListID list;
+		unsigned int identifier;
+		std::size_t index;
+		// Index in the baseline's list, NotInBaseline if the client has never seen the entity
+		std::size_t previousIndex;
+		std::size_t bits;
+		float priority;
+	};
+
+	// Priority of an entity that was not refreshed carries over, so far away entities are not starved
+	struct Accumulated
+	{
+		float priority;
+		unsigned int round;
+	};
+
+private:
+	template <typename Entry>
+	void addCandidates(ListID list, const std::vector<Entry>& entries, const std::vector<Entry>* previous, const sf::FloatRect& relevanceBounds, sf::Vector2f focus);
+	void place(const WorldSnapshot& world, const WorldSnapshot* baseline, const Candidate& candidate, bool fresh, WorldSnapshot& view) const;
+
+private:
+	std::size_t mByteBudget;
+	std::size_t mBitsLeft;
+	std::vector<Candidate> mCandidates;
+	std::unordered_map<unsigned int, Accumulated> mAccumulated;
+	unsigned int mRound;
+
+	std::size_t mRelevantCount;
+	std::size_t mDeferredCount;
+};
@@ -0,0 +1,157 @@
+#include "JobSystem.hpp"
+
+#include <thread>
+
+JobSystem::JobSystem(std::size_t workerCount)
+	: mShares()
+	, mInvoke(nullptr)
+	, mJob(nullptr)
+	, mRemaining(0)
+	, mSteals(0)
+	, mMutex()
+	, mCondition()
+	, mFinished()
+	, mBatch(0)
+	, mRunning(true)
+	, mThreads()
+{
+	for (std::size_t i = 0; i <= workerCount; ++i)
+		mShares.emplace_back(new Share());
+
+	for (std::size_t i = 1; i <= workerCount; ++i)
+	{
+		mThreads.emplace_back(new sf::Thread([this, i] () { work(i); }));
+		mThreads.back()->launch();
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mRunning = false;
+	}
+
+	mCondition.notify_all();
+	for (std::unique_ptr<sf::Thread>& thread : mThreads)
+		thread->wait();
+}
+
+std::size_t JobSystem::getThreadCount() const
+{
+	return mShares.size();
+}
+
+std::size_t JobSystem::takeStealCount()
+{
+	return mSteals.exchange(0);
+}
+
+std::size_t JobSystem::getDefaultWorkerCount()
+{
+	// Zero when the hardware does not say
+	unsigned int threads = std::thread::hardware_concurrency();
+	return threads > 1 ? threads - 1 : 0;
+}
+
+void JobSystem::runBatch(std::size_t count, Invoke invoke, const void* job)
+{
+	if (count == 0)
+		return;
+
+	if (mThreads.empty() || count == 1)
+	{
+		for (std::size_t index = 0; index < count; ++index)
+			invoke(job, index);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mInvoke = invoke;
+		mJob = job;
+		mRemaining = count;
+
+		// Consecutive jobs go to the same thread, which keeps neighbouring data on one core unless it is stolen
+		std::size_t threads = mShares.size();
+		for (std::size_t thread = 0; thread < threads; ++thread)
+		{
+			Share& share = *mShares[thread];
+			std::lock_guard<std::mutex> shareLock(share.mutex);
+			for (std::size_t index = thread * count / threads; index < (thread + 1) * count / threads; ++index)
+				share.jobs.push_back(index);
+		}
+
+		++mBatch;
+	}
+
+	mCondition.notify_all();
+	runJobs(0);
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	mFinished.wait(lock, [this] () { return mRemaining == 0; });
+}
+
+void JobSystem::work(std::size_t thread)
+{
+	std::size_t batch = 0;
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	while (true)
+	{
+		mCondition.wait(lock, [&] () { return mBatch != batch || !mRunning; });
+		if (!mRunning)
+			break;
+
+		batch = mBatch;
+		lock.unlock();
+		runJobs(thread);
+		lock.lock();
+	}
+}
+
+void JobSystem::runJobs(std::size_t thread)
+{
+	std::size_t index;
+	while (takeJob(thread, index))
+	{
+		mInvoke(mJob, index);
+
+		// Notified under the lock, so the caller cannot miss it between checking and waiting
+		if (--mRemaining == 0)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mFinished.notify_all();
+		}
+	}
+}
+
+bool JobSystem::takeJob(std::size_t thread, std::size_t& index)
+{
+	{
+		Share& own = *mShares[thread];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.jobs.empty())
+		{
+			index = own.jobs.front();
+			own.jobs.pop_front();
+			return true;
+		}
+	}
+
+	// Steal the job its owner would get to last, starting with the next thread along
+	for (std::size_t offset = 1; offset < mShares.size(); ++offset)
+	{
+		Share& victim = *mShares[(thread + offset) % mShares.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.jobs.empty())
+		{
+			index = victim.jobs.back();
+			victim.jobs.pop_back();
+			++mSteals;
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Thread.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//Runs batches of independent jobs on a fixed pool of worker threads, with the calling thread joining in
+//Each thread starts on its own share of a batch and, once that is done, steals from the back of the others' shares
+class JobSystem : private sf::NonCopyable
+{
+public:
+	//Without workers every batch runs on the calling thread
+	explicit JobSystem(std::size_t workerCount);
+	~JobSystem();
+
+	//Calls job(index) once for every index below count and returns when all calls have finished
+	//Jobs run in any order on any thread, so they must not write anything another job of the batch touches
+	template<typename Job>
+	void run(std::size_t count, const Job& job);
+
+	//Workers plus the calling thread
+	std::size_t getThreadCount() const;
+	//Jobs a thread took from another thread's share since the last call
+	std::size_t takeStealCount();
+
+	//One worker for every hardware thread besides the calling one
+	static std::size_t getDefaultWorkerCount();
+
+private:
+	typedef void(*Invoke)(const void* job, std::size_t index);
+
+	struct Share
+	{
+		std::mutex mutex;
+		std::deque<std::size_t> jobs;
+	};
+
+private:
+	template<typename Job>
+	static void invoke(const void* job, std::size_t index);
+
+	void runBatch(std::size_t count, Invoke invoke, const void* job);
+	void work(std::size_t thread);
+	void runJobs(std::size_t thread);
+	bool takeJob(std::size_t thread, std::size_t& index);
+
+private:
+	// Share 0 belongs to the calling thread, share i to worker i - 1
+	std::vector<std::unique_ptr<Share>> mShares;
+
+	// The batch being run; written before its jobs are shared out, so a thread that takes a job sees them
+	Invoke mInvoke;
+	const void* mJob;
+	std::atomic<std::size_t> mRemaining;
+	std::atomic<std::size_t> mSteals;
+
+	// Wakes the workers for a new batch, and the caller once the batch is done
+	std::mutex mMutex;
+	std::condition_variable mCondition;
+	std::condition_variable mFinished;
+	std::size_t mBatch;
+	bool mRunning;
+
+	// Declared last, so everything they use exists before they are launched
+	std::vector<std::unique_ptr<sf::Thread>> mThreads;
+};
+
+#include "JobSystem.inl"
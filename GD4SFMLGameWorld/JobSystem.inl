@@ -0,0 +1,12 @@
+template<typename Job>
+void JobSystem::run(std::size_t count, const Job& job)
+{
+	// The job is only called through a plain function pointer, so a batch never allocates
+	runBatch(count, &JobSystem::invoke<Job>, &job);
+}
+
+template<typename Job>
+void JobSystem::invoke(const void* job, std::size_t index)
+{
+	(*static_cast<const Job*>(job))(index);
+}
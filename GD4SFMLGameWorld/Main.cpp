@@ -1,16 +1,585 @@
 #include <stdexcept>
 #include <iostream>
+#include <memory>
+#include <string>
 #include "Application.hpp"
+#include "World.hpp"
+#include "Player.hpp"
+#include "Player2.hpp"
+#include "Replay.hpp"
+#include "Utility.hpp"
+#include "Profiler.hpp"
+#include "GameServer.hpp"
+#include "GameClient.hpp"
+#include "RollbackSession.hpp"
+#include "NetworkProtocol.hpp"
+#include "WorldSnapshot.hpp"
+#include "CollisionGrid.hpp"
+#include "JobSystem.hpp"
 
-int main()
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Sleep.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <random>
+#include <vector>
+
+namespace
+{
+	const sf::Vector2f HeadlessViewSize(1024.f, 768.f);
+	const long MaxPort = 65535;
+	//Well past any core count; a typo should not start thousands of threads
+	const long MaxWorkerThreads = 256;
+
+	void printUsage()
+	{
+		std::cout << "Usage:\n"
+			<< "  GD4SFMLGameWorld [--render-thread] [--max-ticks n] [--no-time-dilation]\n"
+			<< "  GD4SFMLGameWorld --headless ticks [workers] [profile.json]\n"
+			<< "  GD4SFMLGameWorld --replay file\n"
+			<< "  GD4SFMLGameWorld --snapshot-bench ticks\n"
+			<< "  GD4SFMLGameWorld --collision-bench [bullets] [threads]\n"
+			<< "  GD4SFMLGameWorld --server [port] [ticks] [bytes-per-tick]\n"
+			<< "  GD4SFMLGameWorld --bot host [port] [ticks]\n"
+			<< "  GD4SFMLGameWorld --rollback-host [port] [ticks]\n"
+			<< "  GD4SFMLGameWorld --rollback-join host [port] [ticks]\n"
+			<< "Ports are 1 to " << MaxPort << std::endl;
+	}
+
+	//Whole decimal numbers in [min, max] only; "12x", "-1" for a count or a port past 65535 are rejected instead of truncated
+	bool parseArgument(const char* text, long min, long max, long& value)
+	{
+		char* end = nullptr;
+		errno = 0;
+		long parsed = std::strtol(text, &end, 10);
+		if (end == text || *end != '\0' || errno == ERANGE || parsed < min || parsed > max)
+			return false;
+
+		value = parsed;
+		return true;
+	}
+
+	//Optional argument at index; keeps value when it is not given
+	bool parseOptionalArgument(int argc, char* argv[], int index, long min, long max, long& value)
+	{
+		return index >= argc || parseArgument(argv[index], min, max, value);
+	}
+
+	//Same end conditions GameState checks after every update
+	bool hasMissionEnded(const World& world)
+	{
+		return !world.hasAlivePlayer() || !world.hasAlivePlayer2() || world.hasPlayerReachedEnd() || world.hasPlayer2ReachedEnd();
+	}
+
+	void printTickRate(int ticks, sf::Time elapsed)
+	{
+		float seconds = elapsed.asSeconds();
+		std::cout << ticks << " ticks, " << seconds << " s";
+		if (seconds > 0.f)
+			std::cout << ", " << ticks / seconds << " ticks/s";
+		std::cout << std::endl;
+	}
+
+	//Run the simulation without a window for the given number of fixed ticks, restarting the mission when it ends
+	//Entities are updated on the given number of worker threads besides this one; the profile is saved only when a path is given
+	void runHeadless(int ticks, std::size_t workers, const std::string& profileFile)
+	{
+		Profiler profiler;
+		std::unique_ptr<World> world(new World(HeadlessViewSize));
+		world->setProfiler(&profiler);
+		world->setWorkerThreads(workers);
+		int missions = 1;
+
+		sf::Clock clock;
+		for (int tick = 0; tick < ticks; ++tick)
+		{
+			{
+				Profiler::Scope scope(&profiler, ProfileSectionID::Update);
+				world->update(Application::TimePerFrame);
+			}
+			profiler.endFrame();
+
+			if (hasMissionEnded(*world))
+			{
+				world.reset(new World(HeadlessViewSize));
+				world->setProfiler(&profiler);
+				world->setWorkerThreads(workers);
+				++missions;
+			}
+		}
+
+		std::cout << missions << " missions, " << workers << " workers, ";
+		printTickRate(ticks, clock.getElapsedTime());
+		std::cout << profiler.getOverlayText();
+
+		if (!profileFile.empty())
+			profiler.saveToJson(profileFile);
+	}
+
+	//Re-simulate a recorded mission as fast as possible, feeding the recorded input through the command queue
+	void runReplay(const std::string& filename)
+	{
+		Replay replay;
+		if (!replay.loadFromFile(filename))
+			throw std::runtime_error("Replay - Failed to load " + filename);
+
+		seedRandomEngine(replay.getSeed());
+		World world(HeadlessViewSize);
+		Player player;
+		Player2 player2;
+
+		sf::Clock clock;
+		int ticks = 0;
+		while (!replay.isFinished())
+		{
+			ActionBits actions1, actions2;
+			replay.play(actions1, actions2);
+
+			CommandQueue& commands = world.getCommandQueue();
+			player.applyActions(actions1, commands);
+			player2.applyActions(actions2, commands);
+
+			world.update(Application::TimePerFrame);
+			++ticks;
+
+			if (hasMissionEnded(world))
+				break;
+		}
+
+		std::cout << "Replay of " << replay.getTickCount() << " ticks ended at tick " << ticks
+			<< ", player 1 " << (world.hasAlivePlayer() ? "alive" : "dead")
+			<< ", player 2 " << (world.hasAlivePlayer2() ? "alive" : "dead") << ", ";
+		printTickRate(ticks, clock.getElapsedTime());
+	}
+
+	//Encode headless missions (both players firing) every snapshot interval, in full and as a delta to the previous snapshot
+	void runSnapshotBenchmark(int ticks)
+	{
+		const int Repeats = 100;
+
+		std::unique_ptr<World> world(new World(HeadlessViewSize));
+		Player player;
+		Player2 player2;
+		const ActionBits actions = 1 << static_cast<int>(ActionID::Fire) | 1 << static_cast<int>(ActionID::MoveDown);
+
+		WorldSnapshot snapshot;
+		WorldSnapshot decoded;
+		std::deque<WorldSnapshot> history;
+		std::vector<sf::Uint8> buffer;
+		std::vector<sf::Uint8> check;
+
+		std::size_t samples = 0, entities = 0, fullBytes = 0, deltaBytes = 0;
+		sf::Time encodeTime, decodeTime;
+		bool lossless = true;
+
+		for (int tick = 1; tick <= ticks; ++tick)
+		{
+			player.applyActions(actions, world->getCommandQueue());
+			player2.applyActions(actions, world->getCommandQueue());
+			world->update(Application::TimePerFrame);
+
+			if (hasMissionEnded(*world))
+			{
+				world.reset(new World(HeadlessViewSize));
+				history.clear();
+			}
+
+			if (tick % SnapshotInterval != 0)
+				continue;
+
+			world->captureSnapshot(snapshot);
+			snapshot.tick = tick;
+
+			buffer.clear();
+			encodeSnapshot(buffer, snapshot, nullptr);
+			fullBytes += buffer.size();
+
+			const WorldSnapshot* baseline = history.empty() ? nullptr : &history.back();
+			sf::Clock clock;
+			for (int i = 0; i < Repeats; ++i)
+			{
+				buffer.clear();
+				encodeSnapshot(buffer, snapshot, baseline);
+			}
+			encodeTime += clock.getElapsedTime();
+			deltaBytes += buffer.size();
+
+			clock.restart();
+			for (int i = 0; i < Repeats; ++i)
+				decodeSnapshot(buffer.data(), buffer.size(), decoded, history);
+			decodeTime += clock.getElapsedTime();
+
+			//Lossless if the decoded snapshot encodes to the same bytes
+			std::vector<sf::Uint8> expected;
+			encodeSnapshot(expected, snapshot, nullptr);
+			check.clear();
+			encodeSnapshot(check, decoded, nullptr);
+			lossless = lossless && check == expected;
+
+			history.push_back(snapshot);
+			if (history.size() > SnapshotHistorySize)
+				history.pop_front();
+
+			++samples;
+			entities += snapshot.aircraft.size() + snapshot.projectiles.size() + snapshot.pickups.size();
+		}
+
+		if (samples == 0 || entities == 0)
+			return;
+
+		float perEntity = 1.f / entities;
+		float perSnapshot = 1e9f / (samples * Repeats);
+		std::cout << samples << " snapshots, " << static_cast<float>(entities) / samples << " entities each\n"
+			<< "Full:  " << fullBytes * perEntity << " bytes/entity, " << fullBytes / samples << " bytes/snapshot\n"
+			<< "Delta: " << deltaBytes * perEntity << " bytes/entity, " << deltaBytes / samples << " bytes/snapshot\n"
+			<< "Encode " << encodeTime.asSeconds() * perSnapshot << " ns, decode " << decodeTime.asSeconds() * perSnapshot << " ns per delta snapshot ("
+			<< encodeTime.asSeconds() * 1e9f / (entities * Repeats) << " / " << decodeTime.asSeconds() * 1e9f / (entities * Repeats) << " ns/entity)\n"
+			<< "Round trip " << (lossless ? "lossless" : "LOSSY") << std::endl;
+	}
+
+	//Narrow phase over a view full of bullets and aircraft, on 1 to maxThreads threads
+	//Every thread count has to find the same contacts in the same order as the single-threaded pass
+	void runCollisionBenchmark(std::size_t bullets, std::size_t maxThreads)
+	{
+		const int Repeats = 20;
+		const std::size_t AircraftCount = 200;
+		const std::size_t ChunksPerThread = 4;
+
+		// Bodies only need a node to point at; the responses are never run
+		SceneNode owner;
+		CollisionMatrix matrix;
+		auto ignore = [] (const CollisionMatrix::Contact&) {};
+		matrix.add(CategoryID::PlayerAircraft, CategoryID::EnemyAircraft, ignore);
+		matrix.add(CategoryID::EnemyAircraft, CategoryID::AlliedBullet, ignore);
+		matrix.add(CategoryID::PlayerAircraft, CategoryID::EnemyBullet, ignore);
+
+		CollisionGrid grid(128.f);
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> x(0.f, HeadlessViewSize.x);
+		std::uniform_real_distribution<float> y(0.f, HeadlessViewSize.y);
+
+		for (std::size_t i = 0; i < bullets; ++i)
+		{
+			CategoryID category = i % 2 == 0 ? CategoryID::AlliedBullet : CategoryID::EnemyBullet;
+			grid.insert(owner, i, static_cast<unsigned int>(category), sf::FloatRect(x(random), y(random), 3.f, 14.f));
+		}
+		for (std::size_t i = 0; i < AircraftCount; ++i)
+		{
+			CategoryID category = i < 2 ? CategoryID::PlayerAircraft : CategoryID::EnemyAircraft;
+			grid.insert(owner, i, static_cast<unsigned int>(category), sf::FloatRect(x(random), y(random), 60.f, 50.f));
+		}
+
+		std::vector<CollisionMatrix::Contact> expected;
+		sf::Clock clock;
+		for (int i = 0; i < Repeats; ++i)
+		{
+			expected.clear();
+			grid.findContacts(matrix, expected);
+		}
+		sf::Time serialTime = clock.getElapsedTime() / static_cast<sf::Int64>(Repeats);
+
+		std::cout << grid.getColliderCount() << " colliders, " << expected.size() << " contacts\n"
+			<< "Serial:    " << serialTime.asMicroseconds() << " us per tick\n";
+
+		std::vector<CollisionMatrix::Contact> contacts;
+		std::vector<std::vector<CollisionMatrix::Contact>> chunkContacts;
+		for (std::size_t threads = 1; threads <= maxThreads; ++threads)
+		{
+			JobSystem jobs(threads - 1);
+			chunkContacts.assign(threads * ChunksPerThread, std::vector<CollisionMatrix::Contact>());
+
+			clock.restart();
+			for (int i = 0; i < Repeats; ++i)
+			{
+				contacts.clear();
+				grid.findContacts(matrix, contacts, jobs, chunkContacts);
+			}
+			sf::Time time = clock.getElapsedTime() / static_cast<sf::Int64>(Repeats);
+
+			bool same = std::equal(contacts.begin(), contacts.end(), expected.begin(), expected.end(),
+				[] (const CollisionMatrix::Contact& lhs, const CollisionMatrix::Contact& rhs)
+			{
+				return lhs.first.index == rhs.first.index && lhs.first.category == rhs.first.category
+					&& lhs.second.index == rhs.second.index && lhs.second.category == rhs.second.category && lhs.rule == rhs.rule;
+			});
+
+			std::cout << threads << (threads == 1 ? " thread:  " : " threads: ") << time.asMicroseconds() << " us per tick, "
+				<< (time > sf::Time::Zero ? serialTime.asSeconds() / time.asSeconds() : 0.f) << "x serial, "
+				<< (same ? "same contacts" : "DIFFERENT contacts") << std::endl;
+		}
+	}
+
+	//Authoritative server for two "Join Game" windows or bots; stops after the given number of ticks, 0 runs forever
+	void runServer(unsigned short port, unsigned int ticks, std::size_t bytesPerTick)
+	{
+		GameServer server(port, HeadlessViewSize);
+		if (!server.isListening())
+			throw std::runtime_error("GameServer - Failed to bind port " + std::to_string(port));
+
+		server.setBytesPerTick(bytesPerTick);
+
+		std::cout << "Listening on port " << port << std::endl;
+
+		sf::Clock clock;
+		sf::Time reportTime;
+		while (ticks == 0 || server.getTick() < ticks)
+		{
+			sf::Time dt = clock.restart();
+			server.update(dt);
+
+			reportTime += dt;
+			if (reportTime >= sf::seconds(5.f))
+			{
+				reportTime = sf::Time::Zero;
+				std::cout << "Tick " << server.getTick() << ", " << server.getPeerCount() << " clients, "
+					<< server.getSentBytes() << " bytes sent, " << server.getDeferredCount() << " entities deferred" << std::endl;
+			}
+
+			sf::sleep(sf::milliseconds(1));
+		}
+
+		std::cout << "Server stopped at tick " << server.getTick() << ", " << server.getSentBytes() << " bytes sent" << std::endl;
+	}
+
+	//Hug the bottom edge weaving left and right while firing; every few seconds a missile
+	ActionBits botActions(sf::Uint32 tick, sf::Uint32 weavePeriod)
+	{
+		ActionBits actions = 1 << static_cast<int>(ActionID::Fire) | 1 << static_cast<int>(ActionID::MoveDown);
+		actions |= 1 << static_cast<int>((tick / weavePeriod) % 2 == 0 ? ActionID::MoveLeft : ActionID::MoveRight);
+		if (tick % 300 == 0)
+			actions |= 1 << static_cast<int>(ActionID::LaunchMissile);
+
+		return actions;
+	}
+
+	//Headless client with scripted input, to exercise prediction and reconciliation over loopback
+	void runBot(const std::string& host, unsigned short port, unsigned int ticks)
+	{
+		World world(HeadlessViewSize);
+		GameClient client(world, sf::IpAddress(host), port);
+
+		sf::Clock clock;
+		sf::Time timeSinceLastUpdate = sf::Time::Zero;
+		float maxCorrection = 0.f;
+		while (client.getTick() < ticks && !client.hasTimedOut() && !client.isServerFull())
+		{
+			timeSinceLastUpdate += clock.restart();
+			while (timeSinceLastUpdate > Application::TimePerFrame)
+			{
+				timeSinceLastUpdate -= Application::TimePerFrame;
+
+				client.update(Application::TimePerFrame, botActions(client.getTick(), 40));
+
+				sf::Vector2f correction = client.getLastCorrection();
+				maxCorrection = std::max(maxCorrection, std::sqrt(correction.x * correction.x + correction.y * correction.y));
+			}
+
+			if (client.hasStarted() && hasMissionEnded(world))
+				break;
+
+			sf::sleep(sf::milliseconds(1));
+		}
+
+		std::cout << "Bot in seat " << client.getSlot() + 1 << (client.hasTimedOut() ? " timed out" : "")
+			<< ": tick " << client.getTick() << ", largest correction " << maxCorrection
+			<< ", " << client.getReceivedBytes() << " bytes received" << std::endl;
+	}
+
+	//Headless rollback peer with scripted input; hosts when no host address is given
+	//Both peers print the same final state if they stayed in sync
+	void runRollbackBot(const std::string& host, unsigned short port, unsigned int ticks)
+	{
+		World world(HeadlessViewSize);
+		std::unique_ptr<RollbackSession> session(host.empty()
+			? new RollbackSession(world, port)
+			: new RollbackSession(world, sf::IpAddress(host), port));
+
+		if (!session->isListening())
+			throw std::runtime_error("RollbackSession - Failed to bind port " + std::to_string(port));
+
+		sf::Clock clock;
+		sf::Time timeSinceLastUpdate = sf::Time::Zero;
+		while (session->getTick() < ticks && !session->hasTimedOut())
+		{
+			timeSinceLastUpdate += clock.restart();
+			while (timeSinceLastUpdate > Application::TimePerFrame && session->getTick() < ticks)
+			{
+				timeSinceLastUpdate -= Application::TimePerFrame;
+
+				//The seats weave at different rates, so each end keeps guessing the other's input wrong
+				sf::Uint32 tick = session->getTick();
+				session->update(Application::TimePerFrame, botActions(tick, session->getSlot() == 0 ? 40 : 27));
+			}
+
+			sf::sleep(sf::milliseconds(1));
+		}
+
+		//The last ticks were simulated on guesses; wait until both ends have all the input
+		while (!session->isSynchronized() && !session->hasTimedOut())
+		{
+			session->synchronize(clock.restart());
+			sf::sleep(sf::milliseconds(1));
+		}
+
+		WorldState state;
+		world.saveState(state);
+
+		std::cout << "Rollback peer in seat " << session->getSlot() + 1 << (session->hasTimedOut() ? " timed out" : "")
+			<< ": tick " << session->getTick() << ", " << session->getRollbackCount() << " rollbacks, "
+			<< session->getResimulatedTicks() << " ticks resimulated, longest " << session->getLongestRollback().asMicroseconds() << " us\n";
+
+		for (const Aircraft::State& aircraft : state.aircraft)
+			std::cout << "  aircraft " << aircraft.identifier << " at " << aircraft.position.x << ", " << aircraft.position.y << ", " << aircraft.hitpoints << " HP\n";
+		std::cout << "  " << state.projectiles.size() << " missiles, " << state.bullets.positionX.size() << " bullets" << std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
 {
 	try
 	{
-		Application theAmazingGame;
+		if (argc >= 3 && std::string(argv[1]) == "--headless")
+		{
+			long ticks = 0;
+			long workers = 0;
+			if (!parseArgument(argv[2], 1, INT_MAX, ticks) || !parseOptionalArgument(argc, argv, 3, 0, MaxWorkerThreads, workers))
+			{
+				printUsage();
+				return 1;
+			}
+
+			runHeadless(static_cast<int>(ticks), static_cast<std::size_t>(workers), argc >= 5 ? argv[4] : "");
+			return 0;
+		}
+
+		if (argc >= 3 && std::string(argv[1]) == "--replay")
+		{
+			runReplay(argv[2]);
+			return 0;
+		}
+
+		if (argc >= 3 && std::string(argv[1]) == "--snapshot-bench")
+		{
+			long ticks = 0;
+			if (!parseArgument(argv[2], 1, INT_MAX, ticks))
+			{
+				printUsage();
+				return 1;
+			}
+
+			runSnapshotBenchmark(static_cast<int>(ticks));
+			return 0;
+		}
+
+		if (argc >= 2 && std::string(argv[1]) == "--collision-bench")
+		{
+			long bullets = 10000;
+			long threads = static_cast<long>(JobSystem::getDefaultWorkerCount()) + 1;
+			if (!parseOptionalArgument(argc, argv, 2, 0, INT_MAX, bullets) || !parseOptionalArgument(argc, argv, 3, 1, MaxWorkerThreads + 1, threads))
+			{
+				printUsage();
+				return 1;
+			}
+
+			runCollisionBenchmark(static_cast<std::size_t>(bullets), static_cast<std::size_t>(threads));
+			return 0;
+		}
+
+		if (argc >= 2 && std::string(argv[1]) == "--server")
+		{
+			long port = DefaultServerPort;
+			long ticks = 0;
+			long bytesPerTick = static_cast<long>(DefaultBytesPerTick);
+			if (!parseOptionalArgument(argc, argv, 2, 1, MaxPort, port) || !parseOptionalArgument(argc, argv, 3, 0, INT_MAX, ticks)
+				|| !parseOptionalArgument(argc, argv, 4, 1, INT_MAX, bytesPerTick))
+			{
+				printUsage();
+				return 1;
+			}
+
+			runServer(static_cast<unsigned short>(port), static_cast<unsigned int>(ticks), static_cast<std::size_t>(bytesPerTick));
+			return 0;
+		}
+
+		if (argc >= 3 && std::string(argv[1]) == "--bot")
+		{
+			long port = DefaultServerPort;
+			long ticks = 3600;
+			if (!parseOptionalArgument(argc, argv, 3, 1, MaxPort, port) || !parseOptionalArgument(argc, argv, 4, 1, INT_MAX, ticks))
+			{
+				printUsage();
+				return 1;
+			}
+
+			runBot(argv[2], static_cast<unsigned short>(port), static_cast<unsigned int>(ticks));
+			return 0;
+		}
+
+		if (argc >= 2 && std::string(argv[1]) == "--rollback-host")
+		{
+			long port = DefaultRollbackPort;
+			long ticks = 3600;
+			if (!parseOptionalArgument(argc, argv, 2, 1, MaxPort, port) || !parseOptionalArgument(argc, argv, 3, 1, INT_MAX, ticks))
+			{
+				printUsage();
+				return 1;
+			}
+
+			runRollbackBot("", static_cast<unsigned short>(port), static_cast<unsigned int>(ticks));
+			return 0;
+		}
+
+		if (argc >= 3 && std::string(argv[1]) == "--rollback-join")
+		{
+			long port = DefaultRollbackPort;
+			long ticks = 3600;
+			if (!parseOptionalArgument(argc, argv, 3, 1, MaxPort, port) || !parseOptionalArgument(argc, argv, 4, 1, INT_MAX, ticks))
+			{
+				printUsage();
+				return 1;
+			}
+
+			runRollbackBot(argv[2], static_cast<unsigned short>(port), static_cast<unsigned int>(ticks));
+			return 0;
+		}
+
+		//Game options: --render-thread, --max-ticks n (catch-up ticks per frame), --no-time-dilation
+		bool renderThread = false;
+		std::size_t maxTicks = Application::DefaultMaxTicksPerFrame;
+		long ticks = 0;
+		bool timeDilation = true;
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string option = argv[i];
+			if (option == "--render-thread")
+				renderThread = true;
+			else if (option == "--max-ticks" && i + 1 < argc && parseArgument(argv[i + 1], 1, INT_MAX, ticks))
+			{
+				maxTicks = static_cast<std::size_t>(ticks);
+				++i;
+			}
+			else if (option == "--no-time-dilation")
+				timeDilation = false;
+			else
+			{
+				// Also catches a mode above given without its required arguments, such as --bot without a host
+				printUsage();
+				return 1;
+			}
+		}
+
+		Application theAmazingGame(renderThread);
+		theAmazingGame.setMaxTicksPerFrame(maxTicks);
+		theAmazingGame.setTimeDilation(timeDilation);
 		theAmazingGame.run();
 	}
 	catch (std::exception& e)
 	{
 		std::cout << "\n EXCEPTION" << e.what() << std::endl;
 	}
-}
\ No newline at end of file
+}
@@ -22,8 +22,18 @@ MenuState::MenuState(StateStack& stack, Context context)
 		requestStackPush(StateID::Game);
 	});
 
+	//Joins a server started with "--server" on this machine
+	auto joinButton = std::make_shared<GUI::Button>(context);
+	joinButton->setPosition(100, 300);
+	joinButton->setText("Join Game");
+	joinButton->setCallback([this]()
+	{
+		requestStackPop();
+		requestStackPush(StateID::NetworkGame);
+	});
+
 	auto settingsButton = std::make_shared<GUI::Button>(context);
-	settingsButton->setPosition(100, 300);
+	settingsButton->setPosition(100, 350);
 	settingsButton->setText("Settings");
 	settingsButton->setCallback([this]()
 	{
@@ -31,7 +41,7 @@ MenuState::MenuState(StateStack& stack, Context context)
 	});
 
 	auto exitButton = std::make_shared<GUI::Button>(context);
-	exitButton->setPosition(100, 350);
+	exitButton->setPosition(100, 400);
 	exitButton->setText("Exit");
 	exitButton->setCallback([this]()
 	{
@@ -39,6 +49,7 @@ MenuState::MenuState(StateStack& stack, Context context)
 	});
 
 	mGUIContainer.pack(playButton);
+	mGUIContainer.pack(joinButton);
 	mGUIContainer.pack(settingsButton);
 	mGUIContainer.pack(exitButton);
 
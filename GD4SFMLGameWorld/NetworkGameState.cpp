@@ -0,0 +1,105 @@
+#include "NetworkGameState.hpp"
+#include "NetworkProtocol.hpp"
+#include "ResourceHolder.hpp"
+#include "Utility.hpp"
+
+#include <SFML/Graphics/RenderWindow.hpp>
+
+NetworkGameState::NetworkGameState(StateStack& stack, Context context)
+	: State(stack, context)
+	, mWorld(*context.window, *context.fonts, *context.sounds)
+	, mPlayer(*context.player)
+	, mPlayer2(*context.player2)
+	, mClient(mWorld, sf::IpAddress::LocalHost, DefaultServerPort)
+	, mStatusText()
+{
+	mWorld.setProfiler(context.profiler);
+	mWorld.setWorkerThreads(JobSystem::getDefaultWorkerCount());
+
+	mStatusText.setFont(context.fonts->get(FontID::Main));
+	mStatusText.setString("Waiting for the server...");
+	mStatusText.setCharacterSize(40);
+	centreOrigin(mStatusText);
+	mStatusText.setPosition(0.5f * context.window->getSize().x, 0.4f * context.window->getSize().y);
+
+	mPlayer.setMissionStatus(MissionStatusID::MissionRunning);
+	mPlayer2.setMissionStatus(MissionStatusID::MissionRunning);
+	context.music->play(MusicID::MissionTheme);
+}
+
+void NetworkGameState::draw()
+{
+	mWorld.draw(getInterpolation());
+
+	if (!mClient.hasStarted())
+	{
+		sf::RenderWindow& window = *getContext().window;
+		window.setView(window.getDefaultView());
+		window.draw(mStatusText);
+	}
+}
+
+bool NetworkGameState::update(sf::Time dt)
+{
+	//Whichever seat the server gave us, the local player uses player 1's keys
+	mClient.update(dt, mPlayer.sampleActions());
+
+	if (mClient.hasTimedOut() || mClient.isServerFull())
+	{
+		returnToMenu();
+		return true;
+	}
+
+	if (!mClient.hasStarted())
+	{
+		mStatusText.setString(mClient.isConnected() ? "Waiting for player 2..." : "Waiting for the server...");
+		centreOrigin(mStatusText);
+		return true;
+	}
+
+	//The server decides deaths, the replica only shows them
+	if (!mWorld.hasAlivePlayer())
+	{
+		mPlayer.setMissionStatus(MissionStatusID::MissionFailure);
+		requestStackPush(StateID::GameOver);
+	}
+	if (!mWorld.hasAlivePlayer2())
+	{
+		mPlayer2.setMissionStatus(MissionStatusID::MissionFailure);
+		requestStackPush(StateID::GameOver);
+	}
+	else if (mWorld.hasPlayerReachedEnd())
+	{
+		mPlayer.setMissionStatus(MissionStatusID::MissionSuccess);
+		requestStackPush(StateID::GameOver);
+	}
+	else if (mWorld.hasPlayer2ReachedEnd())
+	{
+		mPlayer2.setMissionStatus(MissionStatusID::MissionSuccess);
+		requestStackPush(StateID::GameOver);
+	}
+
+	return true;
+}
+
+bool NetworkGameState::handleEvent(const sf::Event& event)
+{
+	mPlayer.recordEvent(event);
+
+	//The server keeps running, so there is no pause; escape leaves the mission
+	if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape)
+		returnToMenu();
+
+	return true;
+}
+
+bool NetworkGameState::needsRealTime() const
+{
+	return true;
+}
+
+void NetworkGameState::returnToMenu()
+{
+	requestStackClear();
+	requestStackPush(StateID::Menu);
+}
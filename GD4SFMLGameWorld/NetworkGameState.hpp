@@ -0,0 +1,31 @@
+#pragma once
+
+#include "State.hpp"
+#include "World.hpp"
+#include "Player.hpp"
+#include "Player2.hpp"
+#include "GameClient.hpp"
+#include <SFML/Graphics/Text.hpp>
+
+//Two-player mission against a GameServer; this window flies one aircraft with player 1's key bindings
+class NetworkGameState : public State
+{
+public:
+	NetworkGameState(StateStack& stack, Context context);
+
+	virtual void draw();
+	virtual bool update(sf::Time dt);
+	virtual bool handleEvent(const sf::Event& event);
+	//The client predicts on the server's tick rate; a slowed or skipped tick leaves it behind the server for good
+	virtual bool needsRealTime() const;
+
+private:
+	void returnToMenu();
+
+private:
+	World mWorld;
+	Player& mPlayer;
+	Player2& mPlayer2;
+	GameClient mClient;
+	sf::Text mStatusText;
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include "ActionID.hpp"
+
+#include <SFML/Config.hpp>
+
+#include <cstddef>
+
+//Shared constants of the two-player UDP protocol; both ends tick at Application::TimePerFrame
+const sf::Uint32 ProtocolVersion = 1;
+const unsigned short DefaultServerPort = 53000;
+const std::size_t MaxClients = 2;
+
+//The server broadcasts a snapshot every this many ticks (20 Hz)
+const sf::Uint32 SnapshotInterval = 3;
+
+//Snapshots both ends keep as delta baselines, 1.6 s at the snapshot rate
+const std::size_t SnapshotHistorySize = 32;
+
+//Snapshot budget per client in bytes per server tick, spent every SnapshotInterval ticks
+const std::size_t DefaultBytesPerTick = 64;
+
+//Marks "no snapshot" where a tick is expected, e.g. a full snapshot's baseline
+const sf::Uint32 NoSnapshot = 0xFFFFFFFF;
+
+//Each input packet repeats this many of the newest inputs, so a lost datagram costs nothing
+const std::size_t InputRedundancy = 8;
+
+//Clients run this many ticks ahead of the newest snapshot, so their input reaches the server before it is needed
+const sf::Int32 InputLead = 6;
+
+//Repeating a held key when an input is late is harmless; repeating a missile launch is not
+const ActionBits OneShotActions = 1 << static_cast<int>(ActionID::LaunchMissile);
+
+const float ConnectionTimeout = 5.f;
+
+//Peer-to-peer rollback sessions (no server) listen here by default
+const unsigned short DefaultRollbackPort = 53001;
+
+//A rollback session guesses at most this many ticks of the other player's input; further ahead it waits for them
+//This also caps a rollback at this many resimulated ticks per frame
+const sf::Uint32 MaxRollbackTicks = 8;
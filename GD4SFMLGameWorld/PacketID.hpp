@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+
+//First byte of every datagram between GameServer and GameClient, or between two RollbackSessions
+enum class PacketID : std::uint8_t
+{
+	ClientHello,
+	ClientInput,
+	ClientDisconnect,
+	ServerWelcome,
+	ServerFull,
+	ServerSnapshot,
+	PeerHello,
+	PeerWelcome,
+	PeerInput,
+	PeerDisconnect
+};
@@ -1,33 +1,60 @@
 #include "ParticleNode.hpp"
 #include "DataTables.hpp"
 #include "ResourceHolder.hpp"
+#include "SpriteBatch.hpp"
+#include "RenderFrame.hpp"
 
 #include <SFML/Graphics/Texture.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
 
+#include <algorithm>
+
 namespace
 {
 	const std::vector<ParticleData> Table = initializeParticleData();
 }
 
-ParticleNode::ParticleNode(ParticleID type, const TextureHolder& textures)
+ParticleNode::ParticleNode(ParticleID type, const TextureHolder& textures, bool streamVertices)
 	:SceneNode()
-	, mParticles()
 	, mTexture(textures.get(TextureID::Particle))
 	, mType(type)
-	, mVertexArray(sf::Quads)
+	, mCapacity(Table[static_cast<int>(type)].capacity)
+	, mHead(0)
+	, mCount(0)
+	, mPositionX(mCapacity)
+	, mPositionY(mCapacity)
+	, mColor(mCapacity)
+	, mLifetime(mCapacity)
+	, mAlpha(mCapacity)
+	, mVertices(mCapacity * 4)
+	, mVertexCount(0)
 	, mNeedsVertexUpdate(true)
+	, mStreamVertices(streamVertices && sf::VertexBuffer::isAvailable())
+	, mVertexBuffer(sf::Quads, sf::VertexBuffer::Stream)
+	, mUploadedBytes(0)
+	, mPaused(false)
 {
 }
 
 void ParticleNode::addParticle(sf::Vector2f position)
 {
-	Particle particle;
-	particle.position = position;
-	particle.color = Table[static_cast<int>(mType)].color;
-	particle.lifetime = Table[static_cast<int>(mType)].lifetime;
+	if (mPaused)
+		return;
+
+	//When full, the oldest particle is overwritten; it is the closest one to expiring anyway
+	if (mCount == mCapacity)
+	{
+		mHead = (mHead + 1) % mCapacity;
+		--mCount;
+	}
 
-	mParticles.push_back(particle);
+	std::size_t index = (mHead + mCount) % mCapacity;
+	mPositionX[index] = position.x;
+	mPositionY[index] = position.y;
+	mColor[index] = Table[static_cast<int>(mType)].color;
+	mLifetime[index] = Table[static_cast<int>(mType)].lifetime.asSeconds();
+
+	++mCount;
 }
 
 ParticleID ParticleNode::getParticleType() const
@@ -35,52 +62,125 @@ ParticleID ParticleNode::getParticleType() const
 	return mType;
 }
 
+std::size_t ParticleNode::getParticleCount() const
+{
+	return mCount;
+}
+
+std::size_t ParticleNode::getUploadedBytes() const
+{
+	return mUploadedBytes;
+}
+
+bool ParticleNode::isStreamingVertices() const
+{
+	return mStreamVertices;
+}
+
 unsigned int ParticleNode::getCategory() const
 {
 	return static_cast<int>(CategoryID::ParticleSystem);
 }
 
+void ParticleNode::setPaused(bool paused)
+{
+	mPaused = paused;
+}
+
 void ParticleNode::updateCurrent(sf::Time dt, CommandQueue& commands)
 {
-	//Remove expired particles at the beginning
-	while (!mParticles.empty() && mParticles.front().lifetime <= sf::Time::Zero)
-	{
-		mParticles.pop_front();
-	}
+	if (mPaused)
+		return;
 
-	//Decrease lifetime of existing particles
-	for (Particle& particle : mParticles)
+	//Remove expired particles at the beginning; all share one lifetime, so they expire in order
+	while (mCount > 0 && mLifetime[mHead] <= 0.f)
 	{
-		particle.lifetime -= dt;
+		mHead = (mHead + 1) % mCapacity;
+		--mCount;
 	}
 
+	//Decrease lifetime of existing particles, in the (at most two) contiguous runs of the ring
+	std::size_t firstRun = std::min(mCount, mCapacity - mHead);
+	decreaseLifetimes(mHead, mHead + firstRun, dt.asSeconds());
+	decreaseLifetimes(0, mCount - firstRun, dt.asSeconds());
+
 	mNeedsVertexUpdate = true;
 }
 
 void ParticleNode::drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const
 {
+	mUploadedBytes = 0;
+
 	if (mNeedsVertexUpdate)
 	{
 		computeVertices();
 		mNeedsVertexUpdate = false;
+
+		if (mStreamVertices)
+			uploadVertices();
 	}
 
 	//Apply the particle texture
 	states.texture = &mTexture;
 
 	//Draw the vertices
-	target.draw(mVertexArray, states);
+	if (mVertexCount == 0)
+		return;
+
+	if (mStreamVertices)
+	{
+		target.draw(mVertexBuffer, 0, mVertexCount, states);
+	}
+	else
+	{
+		//Client-side vertices are sent to the driver on every draw
+		target.draw(mVertices.data(), mVertexCount, sf::Quads, states);
+		mUploadedBytes = mVertexCount * sizeof(sf::Vertex);
+	}
 
 }
 
-void ParticleNode::addVertex(float worldX, float worldY, float textCoordX, float textCoordY, const sf::Color& color) const
+void ParticleNode::batchCurrent(SpriteBatch& batch, sf::RenderStates states) const
 {
-	sf::Vertex vertex;
-	vertex.position = sf::Vector2f(worldX, worldY);
-	vertex.texCoords = sf::Vector2f(textCoordX, textCoordY);
-	vertex.color = color;
+	// An empty system would only cost a draw call
+	if (mCount == 0)
+	{
+		mUploadedBytes = 0;
+		return;
+	}
+
+	batch.drawCustom(*this, states);
+}
+
+void ParticleNode::recordCurrent(RenderFrame& frame, sf::RenderStates states) const
+{
+	// The render thread draws a copy; the vertex buffer is left for drawCurrent, which uploads it when it next runs
+	if (mNeedsVertexUpdate)
+	{
+		computeVertices();
+		mNeedsVertexUpdate = mStreamVertices;
+	}
+
+	states.texture = &mTexture;
+	frame.addVertices(mVertices.data(), mVertexCount, sf::Quads, states);
+	mUploadedBytes = mVertexCount * sizeof(sf::Vertex);
+}
 
-	mVertexArray.append(vertex);
+void ParticleNode::decreaseLifetimes(std::size_t begin, std::size_t end, float dt)
+{
+	float* lifetime = mLifetime.data();
+	for (std::size_t i = begin; i < end; ++i)
+		lifetime[i] -= dt;
+}
+
+void ParticleNode::computeAlphas(std::size_t begin, std::size_t end) const
+{
+	const float scale = 255.f / Table[static_cast<int>(mType)].lifetime.asSeconds();
+	const float* lifetime = mLifetime.data();
+	sf::Uint8* alpha = mAlpha.data();
+
+	for (std::size_t i = begin; i < end; ++i)
+		alpha[i] = static_cast<sf::Uint8>(std::max(lifetime[i] * scale, 0.f));
 }
 
 void ParticleNode::computeVertices() const
@@ -88,21 +188,47 @@ void ParticleNode::computeVertices() const
 	sf::Vector2f size(mTexture.getSize());
 	sf::Vector2f half = size / 2.f;
 
-	//Refill vertex array
-	mVertexArray.clear();
-	for (const Particle& particle : mParticles)
+	std::size_t firstRun = std::min(mCount, mCapacity - mHead);
+	computeAlphas(mHead, mHead + firstRun);
+	computeAlphas(0, mCount - firstRun);
+
+	//Overwrite the quads in place, oldest particle first; the buffer was sized for the full capacity
+	sf::Vertex* vertex = mVertices.data();
+	for (std::size_t n = 0; n < mCount; ++n)
 	{
-		sf::Vector2f pos = particle.position;
-		sf::Color color = particle.color;
+		std::size_t i = (n < firstRun) ? mHead + n : n - firstRun;
+		float x = mPositionX[i];
+		float y = mPositionY[i];
+		sf::Color color = mColor[i];
+		color.a = mAlpha[i];
+
+		vertex[0] = sf::Vertex(sf::Vector2f(x - half.x, y - half.y), color, sf::Vector2f(0.f, 0.f));
+		vertex[1] = sf::Vertex(sf::Vector2f(x + half.x, y - half.y), color, sf::Vector2f(size.x, 0.f));
+		vertex[2] = sf::Vertex(sf::Vector2f(x + half.x, y + half.y), color, sf::Vector2f(size.x, size.y));
+		vertex[3] = sf::Vertex(sf::Vector2f(x - half.x, y + half.y), color, sf::Vector2f(0.f, size.y));
+		vertex += 4;
+	}
 
-		float ratio = particle.lifetime.asSeconds() / Table[static_cast<int>(mType)].lifetime.asSeconds();
-		color.a = static_cast<sf::Uint8>(255 * std::max(ratio, 0.f));
+	mVertexCount = mCount * 4;
+}
 
-		addVertex(pos.x - half.x, pos.y - half.y, 0.f, 0.f, color);
-		addVertex(pos.x + half.x, pos.y - half.y, size.x, 0.f, color);
-		addVertex(pos.x + half.x, pos.y + half.y, size.x, size.y, color);
-		addVertex(pos.x - half.x, pos.y + half.y, 0.f, size.y, color);
+void ParticleNode::uploadVertices() const
+{
+	//Grow geometrically, so a swelling smoke trail only reallocates a handful of times
+	if (mVertexBuffer.getVertexCount() < mVertexCount)
+	{
+		std::size_t size = std::min(std::max(mVertexCount, mVertexBuffer.getVertexCount() * 2), mVertices.size());
+		if (!mVertexBuffer.create(size))
+		{
+			mStreamVertices = false;
+			return;
+		}
 	}
 
-
+	//Only the live range is sent; anything past it is stale but never drawn
+	if (mVertexCount > 0)
+	{
+		mVertexBuffer.update(mVertices.data(), mVertexCount, 0);
+		mUploadedBytes = mVertexCount * sizeof(sf::Vertex);
+	}
 }
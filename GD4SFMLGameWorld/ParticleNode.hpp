@@ -1,35 +1,62 @@
 #pragma once
 #include "SceneNode.hpp"
 #include "ResourceIdentifiers.hpp"
-#include "Particle.hpp"
 #include "ParticleID.hpp"
 
-#include <SFML/Graphics/VertexArray.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/VertexBuffer.hpp>
+#include <SFML/Graphics/Color.hpp>
 
-#include <deque>
+#include <vector>
 
 class ParticleNode : public SceneNode
 {
 public:
-	ParticleNode(ParticleID type, const TextureHolder& textures);
+	ParticleNode(ParticleID type, const TextureHolder& textures, bool streamVertices = false);
 
 	void addParticle(sf::Vector2f position);
+	//A paused node neither ages nor takes particles, e.g. while World replays ticks that were already shown
+	void setPaused(bool paused);
 	ParticleID getParticleType() const;
+	std::size_t getParticleCount() const;
+	std::size_t getUploadedBytes() const;
+	bool isStreamingVertices() const;
 	virtual unsigned int getCategory() const;
 
 private:
 	virtual void updateCurrent(sf::Time dt, CommandQueue& commands);
 	virtual void drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const;
+	virtual void batchCurrent(SpriteBatch& batch, sf::RenderStates states) const;
+	virtual void recordCurrent(RenderFrame& frame, sf::RenderStates states) const;
 
-	void addVertex(float worldX, float worldY, float textCoordx, float textCoordY, const sf::Color& color) const;
+	void decreaseLifetimes(std::size_t begin, std::size_t end, float dt);
+	void computeAlphas(std::size_t begin, std::size_t end) const;
 	void computeVertices() const;
+	void uploadVertices() const;
 
 private:
-	std::deque<Particle> mParticles;
 	const sf::Texture& mTexture;
 	ParticleID mType;
 
-	mutable sf::VertexArray mVertexArray;
+	//Fixed-capacity ring buffer, one array per attribute; the oldest particle sits at mHead
+	std::size_t mCapacity;
+	std::size_t mHead;
+	std::size_t mCount;
+	std::vector<float> mPositionX;
+	std::vector<float> mPositionY;
+	std::vector<sf::Color> mColor;
+	std::vector<float> mLifetime;
+
+	mutable std::vector<sf::Uint8> mAlpha;
+	mutable std::vector<sf::Vertex> mVertices;
+	mutable std::size_t mVertexCount;
 	mutable bool mNeedsVertexUpdate;
 
-};
\ No newline at end of file
+	//Optional GPU-side copy of the quads, refreshed only when the particles changed
+	mutable bool mStreamVertices;
+	mutable sf::VertexBuffer mVertexBuffer;
+	mutable std::size_t mUploadedBytes;
+
+	bool mPaused;
+
+};
@@ -4,17 +4,20 @@
 #include "CommandQueue.hpp"
 #include "Utility.hpp"
 #include "ResourceHolder.hpp"
+#include "SpriteBatch.hpp"
 
 #include <SFML/Graphics/RenderTarget.hpp>
 
+#include <cassert>
+
 
 namespace
 {
 	const std::vector<PickupData> Table = initializePickupData();
 }
 
-Pickup::Pickup(PickupID type, const TextureHolder& textures)
-	: Entity(1)
+Pickup::Pickup(PickupID type, const TextureHolder& textures, IdentifierSequence& identifiers)
+	: Entity(1, identifiers)
 	, mType(type)
 	, mSprite(textures.get(Table[static_cast<int>(type)].texture), Table[static_cast<int>(type)].textureRect)
 {
@@ -36,7 +39,30 @@ void Pickup::apply(Aircraft& player) const
 	Table[static_cast<int>(mType)].action(player);
 }
 
+PickupID Pickup::getType() const
+{
+	return mType;
+}
+
+void Pickup::saveState(State& state) const
+{
+	Entity::saveState(state);
+	state.type = mType;
+}
+
+void Pickup::restoreState(const State& state)
+{
+	assert(state.type == mType);
+
+	Entity::restoreState(state);
+}
+
 void Pickup::drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const
 {
 	target.draw(mSprite, states);
+}
+
+void Pickup::batchCurrent(SpriteBatch& batch, sf::RenderStates states) const
+{
+	batch.draw(mSprite, states);
 }
\ No newline at end of file
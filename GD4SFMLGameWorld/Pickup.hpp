@@ -12,16 +12,27 @@ class Aircraft;
 class Pickup : public Entity
 {
 public:
-	Pickup(PickupID type, const TextureHolder& textures);
+	struct State : Entity::State
+	{
+		PickupID				type;
+	};
+
+public:
+	Pickup(PickupID type, const TextureHolder& textures, IdentifierSequence& identifiers);
 
 	virtual unsigned int	getCategory() const;
 	virtual sf::FloatRect	getBoundingRect() const;
 
 	void 					apply(Aircraft& player) const;
+	PickupID				getType() const;
+
+	void					saveState(State& state) const;
+	void					restoreState(const State& state);
 
 
 protected:
 	virtual void			drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const;
+	virtual void			batchCurrent(SpriteBatch& batch, sf::RenderStates states) const;
 
 
 private:
@@ -13,8 +13,12 @@ class Player
 public:
 	Player();
 
-	void handleEvent(const sf::Event& event, CommandQueue& commands);
-	void handleRealtimeInput(CommandQueue& commands);
+	//Key presses of one-shot actions are only recorded here; the next sampleActions() reports them
+	void recordEvent(const sf::Event& event);
+
+	//Input as a bitset: sample once per tick, then apply (live or from a replay)
+	ActionBits sampleActions();
+	void applyActions(ActionBits actions, CommandQueue& commands);
 
 	void assignKey(ActionID action, sf::Keyboard::Key key);
 	sf::Keyboard::Key getAssignedKey(ActionID action) const;
@@ -22,12 +26,15 @@ public:
 	void setMissionStatus(MissionStatusID status);
 	MissionStatusID getMissionStatus() const;
 
+	//Held actions repeat every tick; the others fire once per key press
+	static bool isRealtimeAction(ActionID action);
+
 private:
 	void initializeActions();
-	static bool isRealtimeAction(ActionID action);
 
 private:
 	std::map<sf::Keyboard::Key, ActionID> mKeyBinding;
 	std::map<ActionID, Command> mActionBinding;
 	MissionStatusID mCurrentMissionStatus;
+	ActionBits mPendingActions;
 };
\ No newline at end of file
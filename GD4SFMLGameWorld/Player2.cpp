@@ -24,7 +24,9 @@ struct AircraftMover
 	sf::Vector2f velocity;
 };
 
-Player2::Player2() : mCurrentMissionStatus(MissionStatusID::MissionRunning)
+Player2::Player2()
+	: mCurrentMissionStatus(MissionStatusID::MissionRunning)
+	, mPendingActions(0)
 {
 	// Set initial key bindings
 	mKeyBinding[sf::Keyboard::Left] = ActionID::MoveLeft;
@@ -42,30 +44,43 @@ Player2::Player2() : mCurrentMissionStatus(MissionStatusID::MissionRunning)
 		pair.second.category = static_cast<int>(CategoryID::Player2Aircraft);
 }
 
-void Player2::handleEvent(const sf::Event& event, CommandQueue& commands)
+void Player2::recordEvent(const sf::Event& event)
 {
 	if (event.type == sf::Event::KeyPressed)
 	{
-		// Check if pressed key appears in key binding, trigger command if so
+		// Check if pressed key appears in key binding, record its action if so
 		auto found = mKeyBinding.find(event.key.code);
 
 		if (found != mKeyBinding.end() && !isRealtimeAction(found->second))
 		{
-			commands.push(mActionBinding[found->second]);
+			// Deferred to the next sample, so one-shot actions are recorded with the tick they belong to
+			mPendingActions |= 1 << static_cast<int>(found->second);
 		}
 	}
 }
 
-void Player2::handleRealtimeInput(CommandQueue& commands)
+ActionBits Player2::sampleActions()
 {
+	ActionBits actions = mPendingActions;
+	mPendingActions = 0;
+
 	// Traverse all assigned keys and check if they are pressed
 	for (auto pair : mKeyBinding)
 	{
-		// If key is pressed, lookup action and trigger corresponding command
-		if (sf::Keyboard::isKeyPressed(pair.first) && isRealtimeAction(pair.second))
-		{
-			commands.push(mActionBinding[pair.second]);
-		}
+		if (isRealtimeAction(pair.second) && sf::Keyboard::isKeyPressed(pair.first))
+			actions |= 1 << static_cast<int>(pair.second);
+	}
+
+	return actions;
+}
+
+void Player2::applyActions(ActionBits actions, CommandQueue& commands)
+{
+	// Trigger the command of every action in the set, in ActionID order
+	for (auto& pair : mActionBinding)
+	{
+		if (actions & (1 << static_cast<int>(pair.first)))
+			commands.push(forwardCommand(pair.second));
 	}
 }
 
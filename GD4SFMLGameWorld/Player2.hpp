@@ -13,8 +13,12 @@ class Player2
 public:
 	Player2();
 
-	void handleEvent(const sf::Event& event, CommandQueue& commands);
-	void handleRealtimeInput(CommandQueue& commands);
+	//Key presses of one-shot actions are only recorded here; the next sampleActions() reports them
+	void recordEvent(const sf::Event& event);
+
+	//Input as a bitset: sample once per tick, then apply (live or from a replay)
+	ActionBits sampleActions();
+	void applyActions(ActionBits actions, CommandQueue& commands);
 
 	void assignKey(ActionID action, sf::Keyboard::Key key);
 	sf::Keyboard::Key getAssignedKey(ActionID action) const;
@@ -30,4 +34,5 @@ private:
 	std::map<sf::Keyboard::Key, ActionID> mKeyBinding;
 	std::map<ActionID, Command> mActionBinding;
 	MissionStatusID mCurrentMissionStatus;
+	ActionBits mPendingActions;
 };
\ No newline at end of file
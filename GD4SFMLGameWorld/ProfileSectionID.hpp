@@ -0,0 +1,21 @@
+#pragma once
+
+//Timed stages of a frame, shown in the profiler overlay
+enum class ProfileSectionID
+{
+	Frame,
+	Update,
+	Commands,
+	Collisions,
+	RemoveWrecks,
+	SpawnEnemies,
+	SceneUpdate,
+	Sounds,
+	Draw,
+	BloomBrightness,
+	BloomDownsample,
+	BloomBlur,
+	BloomAdd,
+	Display,
+	SectionCount
+};
@@ -0,0 +1,197 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+	const char* SectionNames[] =
+	{
+		"Frame",
+		"Update",
+		"Commands",
+		"Collisions",
+		"RemoveWrecks",
+		"SpawnEnemies",
+		"SceneUpdate",
+		"Sounds",
+		"Draw",
+		"BloomBrightness",
+		"BloomDownsample",
+		"BloomBlur",
+		"BloomAdd",
+		"Display",
+	};
+
+	static_assert(sizeof(SectionNames) / sizeof(SectionNames[0]) == static_cast<std::size_t>(ProfileSectionID::SectionCount), "Every profile section needs a name");
+
+	std::string toMilliseconds(sf::Time time)
+	{
+		std::ostringstream stream;
+		stream << std::fixed << std::setprecision(3) << time.asMicroseconds() / 1000.0;
+		return stream.str();
+	}
+}
+
+Profiler::Scope::Scope(Profiler* profiler, ProfileSectionID section)
+	: mProfiler(profiler)
+	, mSection(section)
+	, mClock()
+{
+}
+
+Profiler::Scope::~Scope()
+{
+	if (mProfiler)
+		mProfiler->addSample(mSection, mClock.getElapsedTime());
+}
+
+Profiler::Profiler(std::size_t historySize)
+	: mCurrentFrame()
+	, mHistory(historySize)
+	, mHistorySize(historySize)
+	, mHistoryNext(0)
+	, mFrameCount(0)
+	, mCounters()
+{
+	mCurrentFrame.fill(0);
+}
+
+void Profiler::addSample(ProfileSectionID section, sf::Time time)
+{
+	// A section can run several times per frame (several updates, blur passes), so samples add up
+	mCurrentFrame[static_cast<std::size_t>(section)] += time.asMicroseconds();
+}
+
+void Profiler::setCounter(const std::string& name, std::size_t value)
+{
+	mCounters[name] = value;
+}
+
+void Profiler::endFrame()
+{
+	mHistory[mHistoryNext] = mCurrentFrame;
+	mHistoryNext = (mHistoryNext + 1) % mHistorySize;
+	++mFrameCount;
+
+	mCurrentFrame.fill(0);
+}
+
+Profiler::Statistics Profiler::getStatistics(ProfileSectionID section) const
+{
+	Statistics statistics = { sf::Time::Zero, sf::Time::Zero, sf::Time::Zero, sf::Time::Zero };
+
+	std::size_t count = std::min(mFrameCount, mHistorySize);
+	if (count == 0)
+		return statistics;
+
+	std::vector<sf::Int64> samples;
+	samples.reserve(count);
+	for (std::size_t age = 0; age < count; ++age)
+		samples.push_back(getFrame(age)[static_cast<std::size_t>(section)]);
+
+	sf::Int64 total = 0;
+	for (sf::Int64 sample : samples)
+		total += sample;
+
+	auto range = std::minmax_element(samples.begin(), samples.end());
+	statistics.min = sf::microseconds(*range.first);
+	statistics.max = sf::microseconds(*range.second);
+	statistics.average = sf::microseconds(total / static_cast<sf::Int64>(count));
+
+	// Nearest-rank percentile: the smallest sample that at least 99% of frames do not exceed
+	std::size_t rank = (count * 99 + 99) / 100 - 1;
+	std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+	statistics.p99 = sf::microseconds(samples[rank]);
+
+	return statistics;
+}
+
+std::size_t Profiler::getFrameCount() const
+{
+	return mFrameCount;
+}
+
+std::string Profiler::getOverlayText() const
+{
+	std::ostringstream text;
+	text << "Section          min / avg / p99 (ms)\n";
+
+	for (std::size_t i = 0; i < SectionCount; ++i)
+	{
+		Statistics statistics = getStatistics(static_cast<ProfileSectionID>(i));
+		text << std::left << std::setw(16) << SectionNames[i] << " "
+			<< toMilliseconds(statistics.min) << " / " << toMilliseconds(statistics.average) << " / " << toMilliseconds(statistics.p99) << "\n";
+	}
+
+	for (const auto& counter : mCounters)
+		text << counter.first << " = " << counter.second << "\n";
+
+	return text.str();
+}
+
+bool Profiler::saveToCsv(const std::string& filename) const
+{
+	// One row per frame in the window, oldest first, so a spike can be traced to its section
+	std::ofstream out(filename);
+	if (!out)
+		return false;
+
+	out << "frame";
+	for (std::size_t i = 0; i < SectionCount; ++i)
+		out << "," << SectionNames[i] << "_us";
+	out << "\n";
+
+	std::size_t count = std::min(mFrameCount, mHistorySize);
+	for (std::size_t age = count; age > 0; --age)
+	{
+		const FrameSample& frame = getFrame(age - 1);
+		out << mFrameCount - age;
+		for (sf::Int64 sample : frame)
+			out << "," << sample;
+		out << "\n";
+	}
+
+	return static_cast<bool>(out);
+}
+
+bool Profiler::saveToJson(const std::string& filename) const
+{
+	std::ofstream out(filename);
+	if (!out)
+		return false;
+
+	out << "{\n  \"frames\": " << mFrameCount << ",\n  \"window\": " << std::min(mFrameCount, mHistorySize) << ",\n  \"sections\": {\n";
+	for (std::size_t i = 0; i < SectionCount; ++i)
+	{
+		Statistics statistics = getStatistics(static_cast<ProfileSectionID>(i));
+		out << "    \"" << SectionNames[i] << "\": { \"min_us\": " << statistics.min.asMicroseconds()
+			<< ", \"avg_us\": " << statistics.average.asMicroseconds()
+			<< ", \"p99_us\": " << statistics.p99.asMicroseconds()
+			<< ", \"max_us\": " << statistics.max.asMicroseconds() << " }"
+			<< (i + 1 < SectionCount ? ",\n" : "\n");
+	}
+
+	out << "  },\n  \"counters\": {\n";
+	std::size_t written = 0;
+	for (const auto& counter : mCounters)
+	{
+		out << "    \"" << counter.first << "\": " << counter.second << (++written < mCounters.size() ? ",\n" : "\n");
+	}
+	out << "  }\n}\n";
+
+	return static_cast<bool>(out);
+}
+
+const char* Profiler::getSectionName(ProfileSectionID section)
+{
+	return SectionNames[static_cast<std::size_t>(section)];
+}
+
+const Profiler::FrameSample& Profiler::getFrame(std::size_t age) const
+{
+	// Age 0 is the most recently finished frame
+	return mHistory[(mHistoryNext + mHistorySize - 1 - age) % mHistorySize];
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "ProfileSectionID.hpp"
+
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+//Per-frame timings of each section over a rolling window of frames, plus named counters
+class Profiler : private sf::NonCopyable
+{
+public:
+	//Adds its lifetime to a section; a null profiler makes it a no-op
+	class Scope : private sf::NonCopyable
+	{
+	public:
+		Scope(Profiler* profiler, ProfileSectionID section);
+		~Scope();
+
+	private:
+		Profiler* mProfiler;
+		ProfileSectionID mSection;
+		sf::Clock mClock;
+	};
+
+	struct Statistics
+	{
+		sf::Time min;
+		sf::Time average;
+		sf::Time p99;
+		sf::Time max;
+	};
+
+public:
+	explicit Profiler(std::size_t historySize = 300);
+
+	void addSample(ProfileSectionID section, sf::Time time);
+	void setCounter(const std::string& name, std::size_t value);
+	void endFrame();
+
+	Statistics getStatistics(ProfileSectionID section) const;
+	std::size_t getFrameCount() const;
+	std::string getOverlayText() const;
+
+	bool saveToCsv(const std::string& filename) const;
+	bool saveToJson(const std::string& filename) const;
+
+	static const char* getSectionName(ProfileSectionID section);
+
+private:
+	static const std::size_t SectionCount = static_cast<std::size_t>(ProfileSectionID::SectionCount);
+	typedef std::array<sf::Int64, SectionCount> FrameSample;
+
+	const FrameSample& getFrame(std::size_t age) const;
+
+private:
+	FrameSample mCurrentFrame;
+
+	// Ring of the last mHistorySize frames, in microseconds
+	std::vector<FrameSample> mHistory;
+	std::size_t mHistorySize;
+	std::size_t mHistoryNext;
+	std::size_t mFrameCount;
+
+	std::map<std::string, std::size_t> mCounters;
+};
@@ -3,6 +3,8 @@
 #include "Utility.hpp"
 #include "ResourceHolder.hpp"
 #include "EmitterNode.hpp"
+#include "ProjectilePool.hpp"
+#include "SpriteBatch.hpp"
 
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/RenderStates.hpp>
@@ -18,8 +20,8 @@ namespace
 	const std::vector<ProjectileData> Table = initializeProjectileData();
 }
 
-Projectile::Projectile(ProjectileID type, const TextureHolder& textures)
-	: Entity(1)
+Projectile::Projectile(ProjectileID type, const TextureHolder& textures, IdentifierSequence& identifiers)
+	: Entity(1, identifiers)
 	, mType(type)
 	, mSprite(textures.get(Table[static_cast<int>(type)].texture), Table[static_cast<int>(type)].textureRect)
 	, mTargetDirection()
@@ -41,6 +43,22 @@ Projectile::Projectile(ProjectileID type, const TextureHolder& textures)
 	}
 }
 
+void* Projectile::operator new(std::size_t size, ProjectilePool& pool)
+{
+	return pool.allocate(size);
+}
+
+void Projectile::operator delete(void* projectile, ProjectilePool&)
+{
+	// Only called when a constructor throws
+	ProjectilePool::deallocate(projectile);
+}
+
+void Projectile::operator delete(void* projectile)
+{
+	ProjectilePool::deallocate(projectile);
+}
+
 void Projectile::guideTowards(sf::Vector2f position)
 {
 	assert(isGuided());
@@ -74,6 +92,11 @@ void Projectile::drawCurrent(sf::RenderTarget& target, sf::RenderStates states)
 	target.draw(mSprite, states);
 }
 
+void Projectile::batchCurrent(SpriteBatch& batch, sf::RenderStates states) const
+{
+	batch.draw(mSprite, states);
+}
+
 unsigned int Projectile::getCategory() const
 {
 	if (mType == ProjectileID::EnemyBullet)
@@ -95,4 +118,24 @@ float Projectile::getMaxSpeed() const
 int Projectile::getDamage() const
 {
 	return Table[static_cast<int>(mType)].damage;
-}
\ No newline at end of file
+}
+
+ProjectileID Projectile::getType() const
+{
+	return mType;
+}
+
+void Projectile::saveState(State& state) const
+{
+	Entity::saveState(state);
+	state.type = mType;
+	state.targetDirection = mTargetDirection;
+}
+
+void Projectile::restoreState(const State& state)
+{
+	assert(state.type == mType);
+
+	Entity::restoreState(state);
+	mTargetDirection = state.targetDirection;
+}
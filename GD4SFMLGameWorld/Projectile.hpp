@@ -7,11 +7,24 @@
 
 #include <SFML/Graphics/Sprite.hpp>
 
+class ProjectilePool;
 
 class Projectile : public Entity
 {
 public:
-	Projectile(ProjectileID type, const TextureHolder& textures);
+	struct State : Entity::State
+	{
+		ProjectileID		type;
+		sf::Vector2f		targetDirection;
+	};
+
+public:
+	Projectile(ProjectileID type, const TextureHolder& textures, IdentifierSequence& identifiers);
+
+	//Projectiles live in their World's pool: new (pool) Projectile(...)
+	static void*			operator new(std::size_t size, ProjectilePool& pool);
+	static void				operator delete(void* projectile, ProjectilePool& pool);
+	static void				operator delete(void* projectile);
 
 	void					guideTowards(sf::Vector2f position);
 	bool					isGuided() const;
@@ -20,11 +33,16 @@ public:
 	virtual sf::FloatRect	getBoundingRect() const;
 	float					getMaxSpeed() const;
 	int						getDamage() const;
+	ProjectileID			getType() const;
+
+	void					saveState(State& state) const;
+	void					restoreState(const State& state);
 
 
 private:
 	virtual void			updateCurrent(sf::Time dt, CommandQueue& commands);
 	virtual void			drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const;
+	virtual void			batchCurrent(SpriteBatch& batch, sf::RenderStates states) const;
 
 
 private:
@@ -0,0 +1,105 @@
+#include "ProjectilePool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+ProjectilePool::ProjectilePool(std::size_t objectSize, std::size_t capacity)
+	: mBlockSize(0)
+	, mCapacity(capacity)
+	, mStorage()
+	, mFreeBlocks()
+	, mInUse(0)
+	, mHighWaterMark(0)
+	, mMisses(0)
+{
+	// Round blocks up so every object behind its header stays suitably aligned
+	const std::size_t alignment = alignof(std::max_align_t);
+	mBlockSize = (headerSize() + objectSize + alignment - 1) / alignment * alignment;
+	mStorage.resize(mBlockSize * mCapacity);
+
+	// Hand out low blocks first, so a small volley stays in the same few cache lines
+	mFreeBlocks.reserve(mCapacity);
+	for (std::size_t i = mCapacity; i > 0; --i)
+		mFreeBlocks.push_back(i - 1);
+}
+
+ProjectilePool::~ProjectilePool()
+{
+	// Objects must be gone before their pool, World declares the pool ahead of its scene graph
+	assert(mInUse == 0);
+}
+
+void* ProjectilePool::allocate(std::size_t size)
+{
+	void* block = nullptr;
+
+	if (!mFreeBlocks.empty() && headerSize() + size <= mBlockSize)
+	{
+		std::size_t index = mFreeBlocks.back();
+		mFreeBlocks.pop_back();
+		block = &mStorage[index * mBlockSize];
+
+		++mInUse;
+		mHighWaterMark = std::max(mHighWaterMark, mInUse);
+		static_cast<BlockHeader*>(block)->owner = this;
+	}
+	else
+	{
+		// Pool exhausted: fall back to the heap and count it, so the capacity can be tuned
+		++mMisses;
+		block = ::operator new(headerSize() + size);
+		static_cast<BlockHeader*>(block)->owner = nullptr;
+	}
+
+	return static_cast<unsigned char*>(block) + headerSize();
+}
+
+void ProjectilePool::deallocate(void* object)
+{
+	if (!object)
+		return;
+
+	void* block = static_cast<unsigned char*>(object) - headerSize();
+	ProjectilePool* owner = static_cast<BlockHeader*>(block)->owner;
+
+	if (owner)
+		owner->release(block);
+	else
+		::operator delete(block);
+}
+
+std::size_t ProjectilePool::getCapacity() const
+{
+	return mCapacity;
+}
+
+std::size_t ProjectilePool::getInUse() const
+{
+	return mInUse;
+}
+
+std::size_t ProjectilePool::getHighWaterMark() const
+{
+	return mHighWaterMark;
+}
+
+std::size_t ProjectilePool::getMisses() const
+{
+	return mMisses;
+}
+
+std::size_t ProjectilePool::headerSize()
+{
+	const std::size_t alignment = alignof(std::max_align_t);
+	return (sizeof(BlockHeader) + alignment - 1) / alignment * alignment;
+}
+
+void ProjectilePool::release(void* block)
+{
+	std::size_t offset = static_cast<std::size_t>(static_cast<unsigned char*>(block) - mStorage.data());
+	assert(offset % mBlockSize == 0 && offset / mBlockSize < mCapacity);
+
+	mFreeBlocks.push_back(offset / mBlockSize);
+	--mInUse;
+}
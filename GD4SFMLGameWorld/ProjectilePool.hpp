@@ -0,0 +1,43 @@
+#pragma once
+#include <SFML/System/NonCopyable.hpp>
+
+#include <cstddef>
+#include <vector>
+
+//Fixed-capacity block pool backing Projectile::operator new, so sustained fire does no heap allocation
+//Each World owns one and is its only user, on the thread that updates that World
+class ProjectilePool : private sf::NonCopyable
+{
+public:
+	ProjectilePool(std::size_t objectSize, std::size_t capacity);
+	~ProjectilePool();
+
+	void* allocate(std::size_t size);
+	//Returns the block to the pool that handed it out, or to the heap after a miss
+	static void deallocate(void* object);
+
+	std::size_t getCapacity() const;
+	std::size_t getInUse() const;
+	std::size_t getHighWaterMark() const;
+	std::size_t getMisses() const;
+
+private:
+	struct BlockHeader
+	{
+		ProjectilePool* owner;
+	};
+
+	static std::size_t headerSize();
+
+	void release(void* block);
+
+private:
+	std::size_t mBlockSize;
+	std::size_t mCapacity;
+	std::vector<unsigned char> mStorage;
+	std::vector<std::size_t> mFreeBlocks;
+
+	std::size_t mInUse;
+	std::size_t mHighWaterMark;
+	std::size_t mMisses;
+};
@@ -0,0 +1,97 @@
+#include "RenderFrame.hpp"
+#include "Utility.hpp"
+
+#include <SFML/Graphics/RenderTarget.hpp>
+
+#include <cassert>
+
+RenderFrame::RenderFrame()
+	: mFont(nullptr)
+	, mView()
+	, mVertices()
+	, mCommands()
+	, mTexts()
+	, mTextCount(0)
+	, mTextVertices()
+{
+}
+
+void RenderFrame::setFont(const sf::Font& font)
+{
+	mFont = &font;
+}
+
+void RenderFrame::clear(const sf::View& view)
+{
+	mView = view;
+	mVertices.clear();
+	mCommands.clear();
+	mTextCount = 0;
+}
+
+void RenderFrame::addVertices(const sf::Vertex* vertices, std::size_t count, sf::PrimitiveType type, const sf::RenderStates& states)
+{
+	if (count == 0)
+		return;
+
+	Command command = { states, type, mVertices.size(), count, NoText };
+	mCommands.push_back(command);
+	mVertices.insert(mVertices.end(), vertices, vertices + count);
+}
+
+void RenderFrame::addText(const sf::Text& text, const sf::RenderStates& states)
+{
+	if (mTextCount == mTexts.size())
+		mTexts.push_back(text);
+	else
+		mTexts[mTextCount] = text;
+
+	// Only the font pointer changes here; the glyphs are laid out when the render thread draws the copy
+	assert(mFont);
+	mTexts[mTextCount].setFont(*mFont);
+
+	Command command = { states, sf::Quads, 0, 0, mTextCount };
+	mCommands.push_back(command);
+	++mTextCount;
+}
+
+void RenderFrame::draw(sf::RenderTarget& target) const
+{
+	target.setView(mView);
+
+	for (std::size_t i = 0; i < mCommands.size(); )
+	{
+		const Command& command = mCommands[i];
+		if (command.text == NoText)
+		{
+			target.draw(&mVertices[command.first], command.count, command.type, command.states);
+			++i;
+			continue;
+		}
+
+		// Consecutive texts of one size share the font page and go out in one draw call
+		const unsigned int size = mTexts[command.text].getCharacterSize();
+		mTextVertices.clear();
+		for (; i < mCommands.size() && mCommands[i].text != NoText; ++i)
+		{
+			const Command& text = mCommands[i];
+			if (mTexts[text.text].getCharacterSize() != size || text.states.blendMode != command.states.blendMode || text.states.shader != command.states.shader)
+				break;
+
+			appendGlyphQuads(mTextVertices, mTexts[text.text], text.states.transform);
+		}
+
+		sf::RenderStates states(command.states.blendMode, sf::Transform::Identity, &mFont->getTexture(size), command.states.shader);
+		target.draw(mTextVertices.data(), mTextVertices.size(), sf::Quads, states);
+	}
+}
+
+std::size_t RenderFrame::getCommandCount() const
+{
+	return mCommands.size();
+}
+
+std::size_t RenderFrame::getVertexCount() const
+{
+	return mVertices.size();
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <SFML/Graphics/RenderStates.hpp>
+#include <SFML/Graphics/Text.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/View.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace sf
+{
+	class RenderTarget;
+}
+
+//Flat list of everything World draws in one frame, copied out of the scene graph
+//so a render thread can draw it while the simulation moves on to the next tick
+class RenderFrame : private sf::NonCopyable
+{
+public:
+	RenderFrame();
+
+	//Texts are drawn with this font instead of their own: sf::Font loads glyphs lazily, so the simulation's font
+	//cannot be shared with the render thread, which gets its own copy of the file
+	void setFont(const sf::Font& font);
+
+	//Keeps the storage, so recording a steady scene stops allocating after the first frames
+	void clear(const sf::View& view);
+	void addVertices(const sf::Vertex* vertices, std::size_t count, sf::PrimitiveType type, const sf::RenderStates& states);
+	void addText(const sf::Text& text, const sf::RenderStates& states);
+
+	void draw(sf::RenderTarget& target) const;
+
+	std::size_t getCommandCount() const;
+	std::size_t getVertexCount() const;
+
+private:
+	//A range of mVertices, or one of mTexts when text is not NoText
+	struct Command
+	{
+		sf::RenderStates states;
+		sf::PrimitiveType type;
+		std::size_t first;
+		std::size_t count;
+		std::size_t text;
+	};
+
+	static const std::size_t NoText = static_cast<std::size_t>(-1);
+
+private:
+	const sf::Font* mFont;
+	sf::View mView;
+	std::vector<sf::Vertex> mVertices;
+	std::vector<Command> mCommands;
+	// Copies are assigned into the slots of earlier frames, reusing their string and glyph storage
+	std::vector<sf::Text> mTexts;
+	std::size_t mTextCount;
+	// Glyph quads of consecutive texts, built by the render thread while it draws
+	mutable std::vector<sf::Vertex> mTextVertices;
+};
@@ -0,0 +1,156 @@
+#include "RenderThread.hpp"
+#include "PostEffect.hpp"
+
+#include <SFML/System/Clock.hpp>
+
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+	//The file Application loads as FontID::Main, which every text in World uses
+	const std::string FontFile = "Media/moonhouse.ttf";
+}
+
+RenderThread::RenderThread(sf::Vector2u size)
+	: mFont()
+	, mFrames()
+	, mRecording(0)
+	, mSubmitted(0)
+	, mSceneTexture()
+	, mBloomEffect()
+	, mPictures()
+	, mPresented(NoPicture)
+	, mFinished(NoPicture)
+	, mMutex()
+	, mCondition()
+	, mHasWork(false)
+	, mRunning(true)
+	, mRenderTime()
+	, mWaitTime()
+	, mThread(&RenderThread::run, this)
+{
+	if (!mFont.loadFromFile(FontFile))
+		throw std::runtime_error("RenderThread - Failed to load " + FontFile);
+
+	for (RenderFrame& frame : mFrames)
+		frame.setFont(mFont);
+
+	// Render textures are active on the thread that creates them; release them for the render thread
+	if (PostEffect::isSupported())
+	{
+		mSceneTexture.create(size.x, size.y);
+		mSceneTexture.setActive(false);
+		mBloomEffect.reset(new BloomEffect());
+	}
+
+	for (sf::RenderTexture& picture : mPictures)
+	{
+		picture.create(size.x, size.y);
+		picture.setActive(false);
+	}
+
+	mThread.launch();
+}
+
+RenderThread::~RenderThread()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mRunning = false;
+	}
+
+	mCondition.notify_all();
+	mThread.wait();
+}
+
+RenderFrame& RenderThread::getFrame()
+{
+	return mFrames[mRecording];
+}
+
+void RenderThread::submit()
+{
+	sf::Clock clock;
+
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mCondition.wait(lock, [this] () { return !mHasWork; });
+		mWaitTime = clock.getElapsedTime();
+
+		mPresented = mFinished;
+		mSubmitted = mRecording;
+		mRecording = 1 - mRecording;
+		mHasWork = true;
+	}
+
+	mCondition.notify_all();
+}
+
+const sf::Texture* RenderThread::getPicture() const
+{
+	// Only submit() changes which picture is presented, and it runs on this same thread
+	if (mPresented == NoPicture)
+		return nullptr;
+
+	return &mPictures[mPresented].getTexture();
+}
+
+sf::Time RenderThread::getRenderTime() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mRenderTime;
+}
+
+sf::Time RenderThread::getWaitTime() const
+{
+	return mWaitTime;
+}
+
+void RenderThread::run()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	while (true)
+	{
+		mCondition.wait(lock, [this] () { return mHasWork || !mRunning; });
+		if (!mRunning)
+			break;
+
+		const RenderFrame& frame = mFrames[mSubmitted];
+		std::size_t picture = mPresented == 0 ? 1 : 0;
+
+		// The simulation records into the other frame meanwhile, and only waits for this one in submit()
+		lock.unlock();
+		sf::Clock clock;
+		render(frame, mPictures[picture]);
+		sf::Time renderTime = clock.getElapsedTime();
+		lock.lock();
+
+		mFinished = picture;
+		mRenderTime = renderTime;
+		mHasWork = false;
+		mCondition.notify_all();
+	}
+}
+
+void RenderThread::render(const RenderFrame& frame, sf::RenderTexture& picture)
+{
+	if (mBloomEffect)
+	{
+		mSceneTexture.clear();
+		frame.draw(mSceneTexture);
+		mSceneTexture.display();
+		mBloomEffect->apply(mSceneTexture, picture);
+	}
+	else
+	{
+		picture.clear();
+		frame.draw(picture);
+	}
+
+	picture.display();
+
+	// Deactivating flushes the queued GL commands, so the simulation thread's context sees the whole picture
+	picture.setActive(false);
+}
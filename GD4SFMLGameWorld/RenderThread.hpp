@@ -0,0 +1,68 @@
+#pragma once
+#include "RenderFrame.hpp"
+#include "BloomEffect.hpp"
+
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Thread.hpp>
+#include <SFML/System/Time.hpp>
+
+#include <array>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+//Draws recorded frames, bloom included, into offscreen pictures on its own thread
+//While it draws frame N the simulation runs the next tick and shows the picture of frame N - 1
+class RenderThread : private sf::NonCopyable
+{
+public:
+	explicit RenderThread(sf::Vector2u size);
+	~RenderThread();
+
+	//The frame to record into; it belongs to the simulation thread until submit()
+	RenderFrame& getFrame();
+	//Waits until the previous frame is drawn, then hands this one over and starts recording the next
+	void submit();
+	//The latest finished picture, null until the first frame is drawn
+	const sf::Texture* getPicture() const;
+
+	//Time the render thread spent drawing the previous frame, and submit() spent waiting for it
+	sf::Time getRenderTime() const;
+	sf::Time getWaitTime() const;
+
+private:
+	static const std::size_t NoPicture = static_cast<std::size_t>(-1);
+
+private:
+	void run();
+	void render(const RenderFrame& frame, sf::RenderTexture& picture);
+
+private:
+	// Only the render thread lays text out with it, once the thread runs
+	sf::Font mFont;
+	std::array<RenderFrame, 2> mFrames;
+	std::size_t mRecording;
+	std::size_t mSubmitted;
+
+	// Used on the render thread only once it runs
+	sf::RenderTexture mSceneTexture;
+	std::unique_ptr<BloomEffect> mBloomEffect;
+	std::array<sf::RenderTexture, 2> mPictures;
+
+	// The picture on screen is never drawn into; the next one goes to the other
+	std::size_t mPresented;
+	std::size_t mFinished;
+
+	// Guards everything the two threads share: the fields above once the thread runs, and these
+	mutable std::mutex mMutex;
+	std::condition_variable mCondition;
+	bool mHasWork;
+	bool mRunning;
+	sf::Time mRenderTime;
+	sf::Time mWaitTime;
+
+	// Declared last, so everything it uses exists before it is launched
+	sf::Thread mThread;
+};
@@ -0,0 +1,171 @@
+#include "Replay.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
+namespace
+{
+	// File layout, little endian: magic, version, seed (4), tick count (4), run count (4), then 4 bytes per run
+	const char Magic[4] = { 'R', 'P', 'L', 'Y' };
+	const std::uint8_t Version = 1;
+
+	void writeUint32(std::ostream& out, std::uint32_t value)
+	{
+		char bytes[4];
+		for (int i = 0; i < 4; ++i)
+			bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+		out.write(bytes, 4);
+	}
+
+	bool readUint32(std::istream& in, std::uint32_t& value)
+	{
+		unsigned char bytes[4];
+		if (!in.read(reinterpret_cast<char*>(bytes), 4))
+			return false;
+
+		value = 0;
+		for (int i = 0; i < 4; ++i)
+			value |= static_cast<std::uint32_t>(bytes[i]) << (8 * i);
+		return true;
+	}
+}
+
+Replay::Replay()
+	: mSeed(0)
+	, mRuns()
+	, mTickCount(0)
+	, mPlayRun(0)
+	, mPlayOffset(0)
+{
+}
+
+void Replay::startRecording(unsigned int seed)
+{
+	mSeed = seed;
+	mRuns.clear();
+	mTickCount = 0;
+	rewind();
+}
+
+void Replay::record(ActionBits player1, ActionBits player2)
+{
+	// Extend the last run if the input did not change and the run is not full
+	if (!mRuns.empty())
+	{
+		Run& last = mRuns.back();
+		if (last.player1 == player1 && last.player2 == player2 && last.length < std::numeric_limits<std::uint16_t>::max())
+		{
+			++last.length;
+			++mTickCount;
+			return;
+		}
+	}
+
+	Run run = { 1, player1, player2 };
+	mRuns.push_back(run);
+	++mTickCount;
+}
+
+bool Replay::saveToFile(const std::string& filename) const
+{
+	std::ofstream out(filename, std::ios::binary);
+	if (!out)
+		return false;
+
+	out.write(Magic, sizeof(Magic));
+	out.put(static_cast<char>(Version));
+	writeUint32(out, mSeed);
+	writeUint32(out, static_cast<std::uint32_t>(mTickCount));
+	writeUint32(out, static_cast<std::uint32_t>(mRuns.size()));
+
+	for (const Run& run : mRuns)
+	{
+		char bytes[4] = { static_cast<char>(run.length & 0xff), static_cast<char>(run.length >> 8), static_cast<char>(run.player1), static_cast<char>(run.player2) };
+		out.write(bytes, 4);
+	}
+
+	return static_cast<bool>(out);
+}
+
+bool Replay::loadFromFile(const std::string& filename)
+{
+	std::ifstream in(filename, std::ios::binary);
+	if (!in)
+		return false;
+
+	char magic[4];
+	char version;
+	if (!in.read(magic, 4) || !in.get(version) || !std::equal(magic, magic + 4, Magic) || static_cast<std::uint8_t>(version) != Version)
+		return false;
+
+	std::uint32_t seed, tickCount, runCount;
+	if (!readUint32(in, seed) || !readUint32(in, tickCount) || !readUint32(in, runCount))
+		return false;
+
+	std::vector<Run> runs;
+	runs.reserve(runCount);
+	std::size_t ticks = 0;
+
+	for (std::uint32_t i = 0; i < runCount; ++i)
+	{
+		unsigned char bytes[4];
+		if (!in.read(reinterpret_cast<char*>(bytes), 4))
+			return false;
+
+		Run run = { static_cast<std::uint16_t>(bytes[0] | (bytes[1] << 8)), bytes[2], bytes[3] };
+		ticks += run.length;
+		runs.push_back(run);
+	}
+
+	if (ticks != tickCount)
+		return false;
+
+	mSeed = seed;
+	mRuns.swap(runs);
+	mTickCount = tickCount;
+	rewind();
+	return true;
+}
+
+void Replay::rewind()
+{
+	mPlayRun = 0;
+	mPlayOffset = 0;
+}
+
+bool Replay::isFinished() const
+{
+	return mPlayRun >= mRuns.size();
+}
+
+void Replay::play(ActionBits& player1, ActionBits& player2)
+{
+	// Past the end, both players are idle
+	if (isFinished())
+	{
+		player1 = 0;
+		player2 = 0;
+		return;
+	}
+
+	const Run& run = mRuns[mPlayRun];
+	player1 = run.player1;
+	player2 = run.player2;
+
+	if (++mPlayOffset == run.length)
+	{
+		++mPlayRun;
+		mPlayOffset = 0;
+	}
+}
+
+unsigned int Replay::getSeed() const
+{
+	return mSeed;
+}
+
+std::size_t Replay::getTickCount() const
+{
+	return mTickCount;
+}
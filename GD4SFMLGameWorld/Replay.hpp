@@ -0,0 +1,43 @@
+#pragma once
+#include "ActionID.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//Per-tick input of both players plus the random seed; replaying it on a fixed time step re-runs a mission exactly
+class Replay
+{
+public:
+	Replay();
+
+	void startRecording(unsigned int seed);
+	void record(ActionBits player1, ActionBits player2);
+
+	bool saveToFile(const std::string& filename) const;
+	bool loadFromFile(const std::string& filename);
+
+	void rewind();
+	bool isFinished() const;
+	void play(ActionBits& player1, ActionBits& player2);
+
+	unsigned int getSeed() const;
+	std::size_t getTickCount() const;
+
+private:
+	// Input is usually held for many ticks, so ticks are stored as runs of identical input
+	struct Run
+	{
+		std::uint16_t length;
+		ActionBits player1;
+		ActionBits player2;
+	};
+
+private:
+	unsigned int mSeed;
+	std::vector<Run> mRuns;
+	std::size_t mTickCount;
+
+	std::size_t mPlayRun;
+	std::size_t mPlayOffset;
+};
@@ -18,6 +18,7 @@ public:
 	void load(Identifier id, const std::string& filename);
 	template<typename Parameter>
 	void load(Identifier id, const std::string& filename, const Parameter& secondParameter);
+	void loadEmpty(Identifier id);
 	Resource& get(Identifier);
 	const Resource& get(Identifier) const;
 };
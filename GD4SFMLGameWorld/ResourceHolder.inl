@@ -27,6 +27,14 @@ void ResourceHolder<Resource, Identifier>::load(Identifier id, const std::string
 	insertResource(id, std::move(resource));
 }
 
+template<typename Resource, typename Identifier>
+void ResourceHolder<Resource, Identifier>::loadEmpty(Identifier id)
+{
+	//Insert a default constructed resource, for callers that need the id but never use the contents
+	std::unique_ptr<Resource> resource(new Resource());
+	insertResource(id, std::move(resource));
+}
+
 template<typename Resource, typename Identifier>
 Resource& ResourceHolder<Resource, Identifier>::get(Identifier id)
 {
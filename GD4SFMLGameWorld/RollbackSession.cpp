@@ -0,0 +1,359 @@
+#include "RollbackSession.hpp"
+#include "World.hpp"
+#include "PacketID.hpp"
+#include "Application.hpp"
+
+#include <SFML/Network/Packet.hpp>
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace
+{
+	const sf::Uint32 NoRollback = std::numeric_limits<sf::Uint32>::max();
+}
+
+RollbackSession::RollbackSession(World& world, unsigned short port)
+	: RollbackSession(world, true, sf::IpAddress::None, port)
+{
+}
+
+RollbackSession::RollbackSession(World& world, const sf::IpAddress& host, unsigned short port)
+	: RollbackSession(world, false, host, port)
+{
+}
+
+RollbackSession::RollbackSession(World& world, bool isHost, const sf::IpAddress& host, unsigned short port)
+	: mWorld(world)
+	, mPlayer()
+	, mPlayer2()
+	, mSocket()
+	, mIsHost(isHost)
+	, mIsListening(false)
+	, mPeerAddress(host)
+	, mPeerPort(isHost ? 0 : port)
+	, mClock()
+	, mLastHeard()
+	, mLastHello(sf::seconds(-1.f))
+	, mConnected(false)
+	, mDisconnected(false)
+	, mSlot(isHost ? 0 : 1)
+	, mTick(0)
+	, mLastWait(0)
+	, mPendingActions(0)
+	, mLocalInputs()
+	, mRemoteInputs()
+	, mRemoteTick(0)
+	, mRemoteAck(0)
+	, mRemoteAdvantage(0)
+	, mRollbackTick(NoRollback)
+	, mStates()
+	, mRollbackCount(0)
+	, mResimulatedTicks(0)
+	, mLongestRollback()
+	, mReceivedBytes(0)
+{
+	mIsListening = mSocket.bind(isHost ? port : static_cast<unsigned short>(sf::Socket::AnyPort)) == sf::Socket::Done;
+	mSocket.setBlocking(false);
+}
+
+RollbackSession::~RollbackSession()
+{
+	if (!mConnected)
+		return;
+
+	sf::Packet packet;
+	packet << static_cast<sf::Uint8>(PacketID::PeerDisconnect);
+	mSocket.send(packet, mPeerAddress, mPeerPort);
+}
+
+void RollbackSession::update(sf::Time dt, ActionBits actions)
+{
+	poll(dt);
+	if (!mConnected)
+		return;
+
+	// A one-shot action pressed on a tick we skip is kept for the next one
+	actions |= mPendingActions;
+	mPendingActions = actions & OneShotActions;
+
+	// Guessing further ahead would make rollbacks longer than the budget; wait for the other player instead
+	// The other player may also be ahead of us, which makes the advantage negative
+	sf::Int32 advantage = static_cast<sf::Int32>(mTick - mRemoteTick);
+	if (advantage >= static_cast<sf::Int32>(MaxRollbackTicks))
+	{
+		sendInput();
+		return;
+	}
+
+	// Both ends see the other a few ticks behind; whoever is further ahead than that waits a tick now and then,
+	// so neither is left doing all the rolling back
+	if (advantage - mRemoteAdvantage >= 2 && mTick - mLastWait > MaxRollbackTicks)
+	{
+		mLastWait = mTick;
+		sendInput();
+		return;
+	}
+
+	mPendingActions = 0;
+	mLocalInputs[mTick % InputBufferSize] = actions;
+	simulate(mTick);
+	++mTick;
+
+	sendInput();
+}
+
+void RollbackSession::synchronize(sf::Time dt)
+{
+	poll(dt);
+	if (mConnected)
+		sendInput();
+}
+
+bool RollbackSession::isListening() const
+{
+	return mIsListening;
+}
+
+bool RollbackSession::isConnected() const
+{
+	return mConnected;
+}
+
+bool RollbackSession::hasTimedOut() const
+{
+	// A host waits for its guest as long as it takes
+	if (mDisconnected)
+		return true;
+
+	return (mConnected || !mIsHost) && mClock - mLastHeard > sf::seconds(ConnectionTimeout);
+}
+
+bool RollbackSession::isSynchronized() const
+{
+	return mConnected && mRemoteTick >= mTick && mRemoteAck >= mTick;
+}
+
+std::size_t RollbackSession::getSlot() const
+{
+	return mSlot;
+}
+
+sf::Uint32 RollbackSession::getTick() const
+{
+	return mTick;
+}
+
+sf::Uint32 RollbackSession::getConfirmedTick() const
+{
+	return std::min(mTick, mRemoteTick);
+}
+
+std::size_t RollbackSession::getRollbackCount() const
+{
+	return mRollbackCount;
+}
+
+std::size_t RollbackSession::getResimulatedTicks() const
+{
+	return mResimulatedTicks;
+}
+
+sf::Time RollbackSession::getLongestRollback() const
+{
+	return mLongestRollback;
+}
+
+std::size_t RollbackSession::getReceivedBytes() const
+{
+	return mReceivedBytes;
+}
+
+void RollbackSession::poll(sf::Time dt)
+{
+	mClock += dt;
+	receivePackets();
+
+	// Hellos may be lost like any datagram, so the guest repeats them until the welcome arrives
+	if (!mConnected && !mIsHost && mClock - mLastHello >= sf::seconds(0.5f))
+	{
+		sf::Packet packet;
+		packet << static_cast<sf::Uint8>(PacketID::PeerHello) << ProtocolVersion;
+		mSocket.send(packet, mPeerAddress, mPeerPort);
+		mLastHello = mClock;
+	}
+
+	rollback();
+}
+
+void RollbackSession::receivePackets()
+{
+	sf::Packet packet;
+	sf::IpAddress address;
+	unsigned short port;
+
+	while (mSocket.receive(packet, address, port) == sf::Socket::Done)
+	{
+		mReceivedBytes += packet.getDataSize();
+		handlePacket(packet, address, port);
+	}
+}
+
+void RollbackSession::handlePacket(sf::Packet& packet, const sf::IpAddress& address, unsigned short port)
+{
+	sf::Uint8 id;
+	if (!(packet >> id))
+		return;
+
+	bool fromPeer = mConnected && address == mPeerAddress && port == mPeerPort;
+
+	switch (static_cast<PacketID>(id))
+	{
+	case PacketID::PeerHello:
+	{
+		// The first guest with our protocol version gets the second seat; a repeated hello means the welcome was lost
+		sf::Uint32 version;
+		if (!mIsHost || !(packet >> version) || version != ProtocolVersion || (mConnected && !fromPeer))
+			break;
+
+		mPeerAddress = address;
+		mPeerPort = port;
+		mConnected = true;
+		mLastHeard = mClock;
+
+		sf::Packet welcome;
+		welcome << static_cast<sf::Uint8>(PacketID::PeerWelcome);
+		mSocket.send(welcome, mPeerAddress, mPeerPort);
+		break;
+	}
+
+	case PacketID::PeerWelcome:
+		if (!mIsHost && address == mPeerAddress && port == mPeerPort)
+		{
+			mConnected = true;
+			mLastHeard = mClock;
+		}
+		break;
+
+	case PacketID::PeerInput:
+		if (fromPeer)
+		{
+			mLastHeard = mClock;
+			handleInput(packet);
+		}
+		break;
+
+	case PacketID::PeerDisconnect:
+		if (fromPeer)
+			mDisconnected = true;
+		break;
+
+	default:
+		// Client and server packets belong to the other network mode; ignore them like any stray datagram
+		break;
+	}
+}
+
+void RollbackSession::handleInput(sf::Packet& packet)
+{
+	sf::Uint32 ack;
+	sf::Int32 advantage;
+	sf::Uint32 first;
+	sf::Uint8 count;
+	if (!(packet >> ack >> advantage >> first >> count))
+		return;
+
+	mRemoteAck = std::max(mRemoteAck, ack);
+	mRemoteAdvantage = advantage;
+
+	// Inputs are taken in tick order only, so every tick before mRemoteTick is known
+	for (sf::Uint32 tick = first; tick < first + count; ++tick)
+	{
+		ActionBits actions;
+		if (!(packet >> actions))
+			return;
+
+		if (tick != mRemoteTick)
+			continue;
+
+		// The guess is still in the buffer; if it was wrong, every tick from this one on has to be simulated again
+		std::size_t index = tick % InputBufferSize;
+		if (tick < mTick && mRemoteInputs[index] != actions)
+			mRollbackTick = std::min(mRollbackTick, tick);
+
+		mRemoteInputs[index] = actions;
+		++mRemoteTick;
+	}
+}
+
+void RollbackSession::sendInput()
+{
+	// Everything the other player has not acknowledged, oldest first, with how far ahead of their input we are
+	sf::Uint32 first = std::max(mRemoteAck, mTick > InputBufferSize ? mTick - static_cast<sf::Uint32>(InputBufferSize) : 0);
+	sf::Int32 advantage = static_cast<sf::Int32>(mTick - mRemoteTick);
+
+	sf::Packet packet;
+	packet << static_cast<sf::Uint8>(PacketID::PeerInput) << mRemoteTick << advantage
+		<< first << static_cast<sf::Uint8>(mTick - first);
+
+	for (sf::Uint32 tick = first; tick < mTick; ++tick)
+		packet << mLocalInputs[tick % InputBufferSize];
+
+	mSocket.send(packet, mPeerAddress, mPeerPort);
+}
+
+void RollbackSession::rollback()
+{
+	if (mRollbackTick >= mTick)
+	{
+		mRollbackTick = NoRollback;
+		return;
+	}
+
+	// Only ticks within the guessing window are ever wrong, and their states are still in the ring
+	assert(mTick - mRollbackTick <= MaxRollbackTicks);
+
+	sf::Clock clock;
+	mWorld.restoreState(mStates[mRollbackTick % StateBufferSize]);
+
+	mWorld.setResimulating(true);
+	for (sf::Uint32 tick = mRollbackTick; tick < mTick; ++tick)
+		simulate(tick);
+	mWorld.setResimulating(false);
+
+	++mRollbackCount;
+	mResimulatedTicks += mTick - mRollbackTick;
+	mLongestRollback = std::max(mLongestRollback, clock.getElapsedTime());
+	mRollbackTick = NoRollback;
+}
+
+void RollbackSession::simulate(sf::Uint32 tick)
+{
+	// A tick simulated with real input from both players is never rolled back to, so its state need not be kept
+	std::size_t index = tick % InputBufferSize;
+	if (tick >= mRemoteTick)
+	{
+		mWorld.saveState(mStates[tick % StateBufferSize]);
+		mRemoteInputs[index] = predictRemoteInput();
+	}
+
+	ActionBits local = mLocalInputs[index];
+	ActionBits remote = mRemoteInputs[index];
+
+	CommandQueue& commands = mWorld.getCommandQueue();
+	mPlayer.applyActions(mSlot == 0 ? local : remote, commands);
+	mPlayer2.applyActions(mSlot == 0 ? remote : local, commands);
+
+	mWorld.update(Application::TimePerFrame);
+}
+
+ActionBits RollbackSession::predictRemoteInput() const
+{
+	// Held keys are usually still held; a missile launch is not repeated
+	if (mRemoteTick == 0)
+		return 0;
+
+	return mRemoteInputs[(mRemoteTick - 1) % InputBufferSize] & ~OneShotActions;
+}
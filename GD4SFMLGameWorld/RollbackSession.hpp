@@ -0,0 +1,107 @@
+#pragma once
+#include "Player.hpp"
+#include "Player2.hpp"
+#include "WorldState.hpp"
+#include "NetworkProtocol.hpp"
+
+#include <SFML/Network/UdpSocket.hpp>
+#include <SFML/Network/IpAddress.hpp>
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
+
+#include <array>
+
+class World;
+
+namespace sf
+{
+	class Packet;
+}
+
+//Two-player session without a server: both ends simulate the whole World from both players' input
+//The other player's input is guessed until it arrives; a wrong guess restores the state saved before that tick
+//and simulates the ticks since again, so local input never waits for the network
+class RollbackSession : private sf::NonCopyable
+{
+public:
+	//The host waits on port and flies player 1; the guest joins with the host's address and flies player 2
+	RollbackSession(World& world, unsigned short port);
+	RollbackSession(World& world, const sf::IpAddress& host, unsigned short port);
+	~RollbackSession();
+
+	//One fixed tick: receive, roll back if a guess was wrong, then simulate the next tick with the local input
+	void update(sf::Time dt, ActionBits actions);
+	//Receive, roll back and resend without simulating a new tick, e.g. to settle the end of a match
+	void synchronize(sf::Time dt);
+
+	bool isListening() const;
+	bool isConnected() const;
+	bool hasTimedOut() const;
+	//Both ends have the other's input for every tick simulated so far
+	bool isSynchronized() const;
+
+	std::size_t getSlot() const;
+	sf::Uint32 getTick() const;
+	//Ticks before this one were simulated with both players' real input and will not change
+	sf::Uint32 getConfirmedTick() const;
+	std::size_t getRollbackCount() const;
+	std::size_t getResimulatedTicks() const;
+	sf::Time getLongestRollback() const;
+	std::size_t getReceivedBytes() const;
+
+private:
+	static const std::size_t InputBufferSize = 64;
+	static const std::size_t StateBufferSize = MaxRollbackTicks + 1;
+
+private:
+	// The host binds port; the guest binds any port and sends to host and port
+	RollbackSession(World& world, bool isHost, const sf::IpAddress& host, unsigned short port);
+
+	void poll(sf::Time dt);
+	void receivePackets();
+	void handlePacket(sf::Packet& packet, const sf::IpAddress& address, unsigned short port);
+	void handleInput(sf::Packet& packet);
+	void sendInput();
+	void rollback();
+	void simulate(sf::Uint32 tick);
+	ActionBits predictRemoteInput() const;
+
+private:
+	World& mWorld;
+	Player mPlayer;
+	Player2 mPlayer2;
+
+	sf::UdpSocket mSocket;
+	bool mIsHost;
+	bool mIsListening;
+	sf::IpAddress mPeerAddress;
+	unsigned short mPeerPort;
+	sf::Time mClock;
+	sf::Time mLastHeard;
+	sf::Time mLastHello;
+
+	bool mConnected;
+	bool mDisconnected;
+	std::size_t mSlot;
+	sf::Uint32 mTick;
+	sf::Uint32 mLastWait;
+	ActionBits mPendingActions;
+
+	// Input by tick % InputBufferSize; remote input from mRemoteTick on is a guess
+	std::array<ActionBits, InputBufferSize> mLocalInputs;
+	std::array<ActionBits, InputBufferSize> mRemoteInputs;
+	// The other player's input is known for every tick before mRemoteTick, ours is known to them before mRemoteAck
+	sf::Uint32 mRemoteTick;
+	sf::Uint32 mRemoteAck;
+	sf::Int32 mRemoteAdvantage;
+	// Earliest tick simulated on a wrong guess
+	sf::Uint32 mRollbackTick;
+
+	// State before tick t at t % StateBufferSize, saved for the ticks simulated on a guess
+	std::array<WorldState, StateBufferSize> mStates;
+
+	std::size_t mRollbackCount;
+	std::size_t mResimulatedTicks;
+	sf::Time mLongestRollback;
+	std::size_t mReceivedBytes;
+};
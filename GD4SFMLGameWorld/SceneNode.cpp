@@ -1,6 +1,10 @@
 #include "SceneNode.hpp"
 #include "Command.hpp"
 #include "Utility.hpp"
+#include "CollisionGrid.hpp"
+#include "CategoryRegistry.hpp"
+#include "SpriteBatch.hpp"
+#include "JobSystem.hpp"
 
 #include <SFML/Graphics/RectangleShape.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
@@ -14,12 +18,21 @@ SceneNode::SceneNode(CategoryID category)
 	: mChildren()
 	, mParent(nullptr)
 	, mDefaultCategory(category)
+	, mCategoryRegistry(nullptr)
+	, mWorldTransform()
+	, mWorldTransformDirty(true)
+	, mPreviousPosition()
+	, mPreviousRotation(0.f)
+	, mHasPreviousTransform(false)
 {
 }
 
 void SceneNode::attachChild(Ptr child)
 {
 	child->mParent = this;
+	child->markTransformDirty();
+	if (mCategoryRegistry)
+		child->setCategoryRegistry(mCategoryRegistry);
 	mChildren.push_back(std::move(child));
 }
 
@@ -30,16 +43,48 @@ SceneNode::Ptr SceneNode::detachChild(const SceneNode& node)
 
 	Ptr result = std::move(*found);
 	result->mParent = nullptr;
+	result->markTransformDirty();
+	result->setCategoryRegistry(nullptr);
 	mChildren.erase(found);
 	return result;
 }
 
+void SceneNode::setCategoryRegistry(CategoryRegistry* registry)
+{
+	if (mCategoryRegistry == registry)
+		return;
+
+	if (mCategoryRegistry)
+		mCategoryRegistry->remove(*this);
+
+	mCategoryRegistry = registry;
+
+	if (mCategoryRegistry)
+		mCategoryRegistry->add(*this);
+
+	for (const Ptr& child : mChildren)
+		child->setCategoryRegistry(registry);
+}
+
 void SceneNode::update(sf::Time dt, CommandQueue& commands)
 {
 	updateCurrent(dt, commands);
 	updateChildren(dt, commands);
 }
 
+void SceneNode::update(sf::Time dt, CommandQueue& commands, JobSystem& jobs, std::vector<CommandQueue>& chunkQueues)
+{
+	updateCurrent(dt, commands);
+
+	for (const Ptr& child : mChildren)
+	{
+		// Workers read this node's world transform through their parents, so it must not be refreshed by them
+		child->getWorldTransform();
+		child->updateCurrent(dt, commands);
+		child->updateChildrenInChunks(dt, commands, jobs, chunkQueues);
+	}
+}
+
 void SceneNode::updateCurrent(sf::Time, CommandQueue&)
 {
 	// Do nothing by default
@@ -51,6 +96,30 @@ void SceneNode::updateChildren(sf::Time dt, CommandQueue& commands)
 		child->update(dt, commands);
 }
 
+void SceneNode::updateChildrenInChunks(sf::Time dt, CommandQueue& commands, JobSystem& jobs, std::vector<CommandQueue>& chunkQueues)
+{
+	// Each subtree only changes itself and issues commands for the rest, so whole subtrees are independent jobs
+	std::size_t chunkCount = std::min(chunkQueues.size(), mChildren.size());
+	if (chunkCount <= 1)
+	{
+		updateChildren(dt, commands);
+		return;
+	}
+
+	std::size_t childCount = mChildren.size();
+	jobs.run(chunkCount, [&] (std::size_t chunk)
+	{
+		for (std::size_t i = chunk * childCount / chunkCount; i < (chunk + 1) * childCount / chunkCount; ++i)
+			mChildren[i]->update(dt, chunkQueues[chunk]);
+	});
+
+	for (std::size_t chunk = 0; chunk < chunkCount; ++chunk)
+	{
+		while (!chunkQueues[chunk].isEmpty())
+			commands.push(chunkQueues[chunk].pop());
+	}
+}
+
 void SceneNode::draw(sf::RenderTarget& target, sf::RenderStates states) const
 {
 	// Apply transform of current node
@@ -75,6 +144,57 @@ void SceneNode::drawChildren(sf::RenderTarget& target, sf::RenderStates states)
 		child->draw(target, states);
 }
 
+void SceneNode::drawBatched(SpriteBatch& batch, sf::RenderStates states) const
+{
+	// Children (texts, emitters) stay close to their parent, within the cull margin
+	if (batch.cull(getBoundingRect()))
+		return;
+
+	states.transform *= getInterpolatedTransform(batch.getInterpolation());
+
+	batchCurrent(batch, states);
+
+	for (const Ptr& child : mChildren)
+		child->drawBatched(batch, states);
+}
+
+void SceneNode::storePreviousTransforms()
+{
+	mPreviousPosition = getPosition();
+	mPreviousRotation = getRotation();
+	mHasPreviousTransform = true;
+
+	for (Ptr& child : mChildren)
+		child->storePreviousTransforms();
+}
+
+sf::Transform SceneNode::getInterpolatedTransform(float alpha) const
+{
+	// Most nodes (layers, texts, resting sprites) did not move, and keep the cached transform
+	if (!mHasPreviousTransform || alpha >= 1.f || (mPreviousPosition == getPosition() && mPreviousRotation == getRotation()))
+		return getTransform();
+
+	// Turn the short way round, so a heading crossing 0 degrees does not spin
+	float turn = std::fmod(getRotation() - mPreviousRotation + 540.f, 360.f) - 180.f;
+
+	sf::Transformable blended;
+	blended.setOrigin(getOrigin());
+	blended.setScale(getScale());
+	blended.setPosition(mPreviousPosition + (getPosition() - mPreviousPosition) * alpha);
+	blended.setRotation(mPreviousRotation + turn * alpha);
+	return blended.getTransform();
+}
+
+void SceneNode::batchCurrent(SpriteBatch&, sf::RenderStates) const
+{
+	// Nothing to draw by default; nodes that draw anything override this as well as drawCurrent
+}
+
+void SceneNode::recordCurrent(RenderFrame&, sf::RenderStates) const
+{
+	// Only nodes that pass themselves to SpriteBatch::drawCustom are ever asked to record
+}
+
 void SceneNode::drawBoundingRect(sf::RenderTarget& target, sf::RenderStates) const
 {
 	sf::FloatRect rect = getBoundingRect();
@@ -89,30 +209,120 @@ void SceneNode::drawBoundingRect(sf::RenderTarget& target, sf::RenderStates) con
 	target.draw(shape);
 }
 
+void SceneNode::setPosition(float x, float y)
+{
+	setPosition(sf::Vector2f(x, y));
+}
+
+void SceneNode::setPosition(const sf::Vector2f& position)
+{
+	// Texts and sprites re-apply the same values every frame, which shouldn't invalidate anything
+	if (position == getPosition())
+		return;
+
+	sf::Transformable::setPosition(position);
+	markTransformDirty();
+}
+
+void SceneNode::setRotation(float angle)
+{
+	// Compared the way sf::Transformable stores it, within [0, 360)
+	float normalized = std::fmod(angle, 360.f);
+	if (normalized < 0.f)
+		normalized += 360.f;
+
+	if (normalized == getRotation())
+		return;
+
+	sf::Transformable::setRotation(normalized);
+	markTransformDirty();
+}
+
+void SceneNode::setScale(float factorX, float factorY)
+{
+	setScale(sf::Vector2f(factorX, factorY));
+}
+
+void SceneNode::setScale(const sf::Vector2f& factors)
+{
+	if (factors == getScale())
+		return;
+
+	sf::Transformable::setScale(factors);
+	markTransformDirty();
+}
+
+void SceneNode::setOrigin(float x, float y)
+{
+	setOrigin(sf::Vector2f(x, y));
+}
+
+void SceneNode::setOrigin(const sf::Vector2f& origin)
+{
+	if (origin == getOrigin())
+		return;
+
+	sf::Transformable::setOrigin(origin);
+	markTransformDirty();
+}
+
+void SceneNode::move(float offsetX, float offsetY)
+{
+	move(sf::Vector2f(offsetX, offsetY));
+}
+
+void SceneNode::move(const sf::Vector2f& offset)
+{
+	sf::Transformable::move(offset);
+	markTransformDirty();
+}
+
+void SceneNode::rotate(float angle)
+{
+	sf::Transformable::rotate(angle);
+	markTransformDirty();
+}
+
 sf::Vector2f SceneNode::getWorldPosition() const
 {
 	return getWorldTransform() * sf::Vector2f();
 }
 
-sf::Transform SceneNode::getWorldTransform() const
+const sf::Transform& SceneNode::getWorldTransform() const
 {
-	sf::Transform transform = sf::Transform::Identity;
+	// A clean node always has clean ancestors, so the parent's cached transform can be reused
+	if (mWorldTransformDirty)
+	{
+		if (mParent)
+			mWorldTransform = mParent->getWorldTransform() * getTransform();
+		else
+			mWorldTransform = getTransform();
+
+		mWorldTransformDirty = false;
+	}
+
+	return mWorldTransform;
+}
 
-	for (const SceneNode* node = this; node != nullptr; node = node->mParent)
-		transform = node->getTransform() * transform;
+void SceneNode::updateWorldTransforms()
+{
+	// Refresh top-down, so every node costs one matrix multiply per frame at most
+	getWorldTransform();
 
-	return transform;
+	for (const Ptr& child : mChildren)
+		child->updateWorldTransforms();
 }
 
-void SceneNode::onCommand(const Command& command, sf::Time dt)
+void SceneNode::markTransformDirty()
 {
-	// Command current node, if category matches
-	if (command.category & getCategory())
-		command.action(*this, dt);
+	// A dirty node always has dirty descendants, so the walk can stop there
+	if (mWorldTransformDirty)
+		return;
 
-	// Command children
-	for (Ptr& child : mChildren)
-		child->onCommand(command, dt);
+	mWorldTransformDirty = true;
+
+	for (const Ptr& child : mChildren)
+		child->markTransformDirty();
 }
 
 unsigned int SceneNode::getCategory() const
@@ -120,27 +330,33 @@ unsigned int SceneNode::getCategory() const
 	return static_cast<int>(mDefaultCategory);
 }
 
-void SceneNode::checkSceneCollision(SceneNode& sceneGraph, std::set<Pair>& collisionPairs)
+bool SceneNode::isCollidable() const
 {
-	checkNodeCollision(sceneGraph, collisionPairs);
-
-	for (Ptr& child : sceneGraph.mChildren)
-		checkSceneCollision(*child, collisionPairs);
+	// Layers, texts, particles and sounds never take part in collisions
+	return false;
 }
 
-void SceneNode::checkNodeCollision(SceneNode& node, std::set<Pair>& collisionPairs)
+void SceneNode::collectColliders(CollisionGrid& grid)
 {
-	if (this != &node && collision(*this, node) && !isDestroyed() && !node.isDestroyed())
-		collisionPairs.insert(std::minmax(this, &node));
+	collectCurrentColliders(grid);
 
 	for (Ptr& child : mChildren)
-		child->checkNodeCollision(node, collisionPairs);
+		child->collectColliders(grid);
+}
+
+void SceneNode::collectCurrentColliders(CollisionGrid& grid)
+{
+	if (isCollidable() && !isDestroyed())
+		grid.insert(*this);
 }
 
 void SceneNode::removeWrecks()
 {
-	// Remove all children which request so
-	auto wreckfieldBegin = std::remove_if(mChildren.begin(), mChildren.end(), std::mem_fn(&SceneNode::isMarkedForRemoval));
+	// Remove all children which request so; partition keeps the wrecks intact until they leave the registry
+	auto wreckfieldBegin = std::stable_partition(mChildren.begin(), mChildren.end(), [](const Ptr& child) { return !child->isMarkedForRemoval(); });
+
+	// Wrecks leave the registry with their whole subtree before they are destroyed
+	std::for_each(wreckfieldBegin, mChildren.end(), [](Ptr& wreck) { wreck->setCategoryRegistry(nullptr); });
 	mChildren.erase(wreckfieldBegin, mChildren.end());
 
 	// Call function recursively for all remaining children
@@ -9,10 +9,18 @@
 
 #include <vector>
 #include <memory>
-#include <set>
 
-class SceneNode : public sf::Transformable, public sf::Drawable, private sf::NonCopyable
+class CollisionGrid;
+class CategoryRegistry;
+class SpriteBatch;
+class RenderFrame;
+class JobSystem;
+
+class SceneNode : private sf::Transformable, public sf::Drawable, private sf::NonCopyable
 {
+	// Deferred custom draws call back into drawCurrent, or recordCurrent for a render thread
+	friend class SpriteBatch;
+
 public:
 	typedef std::unique_ptr<SceneNode> Ptr;
 	typedef std::pair<SceneNode*, SceneNode*> Pair;
@@ -23,17 +31,51 @@ public:
 	Ptr detachChild(const SceneNode& node);
 
 	void update(sf::Time dt, CommandQueue& commands);
+	// Same result as update(), but below each child the nodes are updated in chunks on the job system
+	// Every chunk issues into its own queue; the queues are emptied into commands in chunk order,
+	// so commands arrive exactly as update() would have issued them
+	void update(sf::Time dt, CommandQueue& commands, JobSystem& jobs, std::vector<CommandQueue>& chunkQueues);
+
+	// Nodes attached below a registered node join the same registry, so commands reach them directly
+	void setCategoryRegistry(CategoryRegistry* registry);
+
+	// sf::Transformable is a private base, so no change can get past these setters, which invalidate the cached world transform
+	void setPosition(float x, float y);
+	void setPosition(const sf::Vector2f& position);
+	void setRotation(float angle);
+	void setScale(float factorX, float factorY);
+	void setScale(const sf::Vector2f& factors);
+	void setOrigin(float x, float y);
+	void setOrigin(const sf::Vector2f& origin);
+	void move(float offsetX, float offsetY);
+	void move(const sf::Vector2f& offset);
+	void rotate(float angle);
+
+	using sf::Transformable::getPosition;
+	using sf::Transformable::getRotation;
+	using sf::Transformable::getScale;
+	using sf::Transformable::getOrigin;
+	using sf::Transformable::getTransform;
+	using sf::Transformable::getInverseTransform;
 
 	sf::Vector2f getWorldPosition() const;
-	sf::Transform getWorldTransform() const;
+	const sf::Transform& getWorldTransform() const;
+	void updateWorldTransforms();
+
+	// Same traversal as draw(), but sprites go into the batch instead of straight to a target
+	// Nodes are drawn between their previous and current transform by the batch's interpolation
+	void drawBatched(SpriteBatch& batch, sf::RenderStates states) const;
+
+	// Remember every transform before a tick, so drawing can blend from there towards the result
+	void storePreviousTransforms();
+	sf::Transform getInterpolatedTransform(float alpha) const;
 
 	virtual sf::FloatRect	getBoundingRect() const;
 
-	void checkSceneCollision(SceneNode& sceneGraph, std::set<Pair>& collisionPairs);
-	void checkNodeCollision(SceneNode& node, std::set<Pair>& collisionPairs);
+	virtual bool isCollidable() const;
+	void collectColliders(CollisionGrid& grid);
 
 	virtual unsigned int getCategory() const;
-	void onCommand(const Command& command, sf::Time dt);
 	virtual bool isDestroyed() const;
 	virtual bool isMarkedForRemoval() const;
 
@@ -42,16 +84,32 @@ public:
 private:
 	virtual void updateCurrent(sf::Time dt, CommandQueue& commands);
 	void updateChildren(sf::Time dt, CommandQueue& commands);
+	void updateChildrenInChunks(sf::Time dt, CommandQueue& commands, JobSystem& jobs, std::vector<CommandQueue>& chunkQueues);
+
+	virtual void collectCurrentColliders(CollisionGrid& grid);
 
 	virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
 	virtual void drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const;
 	void drawChildren(sf::RenderTarget& target, sf::RenderStates states) const;
+	virtual void batchCurrent(SpriteBatch& batch, sf::RenderStates states) const;
+	virtual void recordCurrent(RenderFrame& frame, sf::RenderStates states) const;
 	void drawBoundingRect(sf::RenderTarget& target, sf::RenderStates states) const;
 
+	void markTransformDirty();
+
 private:
 	std::vector<Ptr> mChildren;
 	SceneNode* mParent;
 	CategoryID mDefaultCategory;
+	CategoryRegistry* mCategoryRegistry;
+
+	mutable sf::Transform mWorldTransform;
+	mutable bool mWorldTransformDirty;
+
+	// Nodes created during the last tick have nothing to blend from and are drawn where they are
+	sf::Vector2f mPreviousPosition;
+	float mPreviousRotation;
+	bool mHasPreviousTransform;
 };
 
 float	distance(const SceneNode& lhs, const SceneNode& rhs);
@@ -0,0 +1,267 @@
+#include "SpriteBatch.hpp"
+#include "SceneNode.hpp"
+#include "RenderFrame.hpp"
+#include "Utility.hpp"
+
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+#include <SFML/Graphics/Text.hpp>
+#include <SFML/Graphics/Font.hpp>
+
+#include <cmath>
+
+SpriteBatch::SpriteBatch()
+	: mAtlas(nullptr)
+	, mCullRect()
+	, mCulling(false)
+	, mInterpolation(1.f)
+	, mBatches()
+	, mBatchCount(0)
+	, mUnderlays()
+	, mOverlays()
+	, mTexts()
+	, mTextVertices()
+	, mDrawCalls(0)
+	, mSprites(0)
+	, mCulled(0)
+	, mVisible(0)
+{
+}
+
+void SpriteBatch::setAtlas(const TextureAtlas* atlas)
+{
+	mAtlas = atlas;
+}
+
+const TextureAtlas::Region* SpriteBatch::findRegion(const sf::Texture* texture) const
+{
+	return mAtlas ? mAtlas->find(texture) : nullptr;
+}
+
+void SpriteBatch::setCullRect(const sf::FloatRect& rect)
+{
+	mCullRect = rect;
+	mCulling = true;
+}
+
+bool SpriteBatch::cull(const sf::FloatRect& bounds)
+{
+	// Layers, texts, particle and bullet systems report no bounds and are always drawn
+	if (!mCulling || (bounds.width == 0.f && bounds.height == 0.f))
+		return false;
+
+	if (!mCullRect.intersects(bounds))
+	{
+		++mCulled;
+		return true;
+	}
+
+	++mVisible;
+	return false;
+}
+
+void SpriteBatch::setInterpolation(float alpha)
+{
+	mInterpolation = alpha;
+}
+
+float SpriteBatch::getInterpolation() const
+{
+	return mInterpolation;
+}
+
+void SpriteBatch::begin()
+{
+	mDrawCalls = 0;
+	mSprites = 0;
+	mCulled = 0;
+	mVisible = 0;
+}
+
+void SpriteBatch::draw(const sf::Sprite& sprite, const sf::RenderStates& states)
+{
+	// Texture rects stay in the source texture's space; the atlas offset is applied here
+	const sf::Texture* texture = sprite.getTexture();
+	sf::Vector2f offset;
+
+	const TextureAtlas::Region* region = findRegion(texture);
+	if (region)
+	{
+		texture = region->page;
+		offset = region->offset;
+	}
+
+	sf::RenderStates batchStates(states.blendMode, sf::Transform::Identity, texture, states.shader);
+	Batch& batch = findBatch(batchStates);
+
+	// Same corners and texture coordinates as sf::Sprite, transformed on the CPU so one draw covers the layer
+	sf::IntRect rect = sprite.getTextureRect();
+	float width = static_cast<float>(std::abs(rect.width));
+	float height = static_cast<float>(std::abs(rect.height));
+
+	float left = offset.x + rect.left;
+	float right = left + rect.width;
+	float top = offset.y + rect.top;
+	float bottom = top + rect.height;
+
+	sf::Transform transform = states.transform * sprite.getTransform();
+	sf::Color color = sprite.getColor();
+
+	batch.vertices.push_back(sf::Vertex(transform.transformPoint(0.f, 0.f), color, sf::Vector2f(left, top)));
+	batch.vertices.push_back(sf::Vertex(transform.transformPoint(width, 0.f), color, sf::Vector2f(right, top)));
+	batch.vertices.push_back(sf::Vertex(transform.transformPoint(width, height), color, sf::Vector2f(right, bottom)));
+	batch.vertices.push_back(sf::Vertex(transform.transformPoint(0.f, height), color, sf::Vector2f(left, bottom)));
+
+	++mSprites;
+}
+
+void SpriteBatch::drawCustom(const SceneNode& node, const sf::RenderStates& states)
+{
+	CustomDraw draw = { &node, states };
+	if (mBatchCount == 0)
+		mUnderlays.push_back(draw);
+	else
+		mOverlays.push_back(draw);
+}
+
+void SpriteBatch::drawText(const sf::Text& text, const sf::RenderStates& states)
+{
+	TextDraw draw = { &text, states };
+	mTexts.push_back(draw);
+}
+
+void SpriteBatch::flush(sf::RenderTarget& target)
+{
+	for (const CustomDraw& draw : mUnderlays)
+		draw.node->drawCurrent(target, draw.states);
+
+	for (std::size_t i = 0; i < mBatchCount; ++i)
+	{
+		const Batch& batch = mBatches[i];
+		target.draw(batch.vertices.data(), batch.vertices.size(), sf::Quads, batch.states);
+	}
+
+	for (const CustomDraw& draw : mOverlays)
+		draw.node->drawCurrent(target, draw.states);
+
+	mDrawCalls += mUnderlays.size() + mBatchCount + mOverlays.size();
+
+	for (std::size_t first = 0; first < mTexts.size(); )
+	{
+		sf::RenderStates runStates;
+		std::size_t end = findTextRunEnd(first, runStates);
+
+		mTextVertices.clear();
+		for (std::size_t i = first; i < end; ++i)
+			appendGlyphQuads(mTextVertices, *mTexts[i].text, mTexts[i].states.transform);
+
+		target.draw(mTextVertices.data(), mTextVertices.size(), sf::Quads, runStates);
+		++mDrawCalls;
+		first = end;
+	}
+
+	reset();
+}
+
+void SpriteBatch::flush(RenderFrame& frame)
+{
+	for (const CustomDraw& draw : mUnderlays)
+		draw.node->recordCurrent(frame, draw.states);
+
+	for (std::size_t i = 0; i < mBatchCount; ++i)
+	{
+		const Batch& batch = mBatches[i];
+		frame.addVertices(batch.vertices.data(), batch.vertices.size(), sf::Quads, batch.states);
+	}
+
+	for (const CustomDraw& draw : mOverlays)
+		draw.node->recordCurrent(frame, draw.states);
+
+	mDrawCalls += mUnderlays.size() + mBatchCount + mOverlays.size();
+
+	// The render thread lays the texts out with its own font, merging the same runs
+	for (std::size_t first = 0; first < mTexts.size(); )
+	{
+		sf::RenderStates runStates;
+		std::size_t end = findTextRunEnd(first, runStates);
+
+		for (std::size_t i = first; i < end; ++i)
+			frame.addText(*mTexts[i].text, mTexts[i].states);
+
+		++mDrawCalls;
+		first = end;
+	}
+
+	reset();
+}
+
+std::size_t SpriteBatch::getDrawCallCount() const
+{
+	return mDrawCalls;
+}
+
+std::size_t SpriteBatch::getSpriteCount() const
+{
+	return mSprites;
+}
+
+std::size_t SpriteBatch::getCulledCount() const
+{
+	return mCulled;
+}
+
+std::size_t SpriteBatch::getVisibleCount() const
+{
+	return mVisible;
+}
+
+SpriteBatch::Batch& SpriteBatch::findBatch(const sf::RenderStates& states)
+{
+	// A layer only ever uses a handful of textures, so a linear search is enough
+	for (std::size_t i = 0; i < mBatchCount; ++i)
+	{
+		Batch& batch = mBatches[i];
+		if (batch.states.texture == states.texture && batch.states.shader == states.shader && batch.states.blendMode == states.blendMode)
+			return batch;
+	}
+
+	if (mBatchCount == mBatches.size())
+		mBatches.push_back(Batch());
+
+	Batch& batch = mBatches[mBatchCount];
+	batch.states = states;
+
+	++mBatchCount;
+	return batch;
+}
+
+std::size_t SpriteBatch::findTextRunEnd(std::size_t first, sf::RenderStates& runStates) const
+{
+	// Glyph quads carry their transform, so texts only need the same font page, blend mode and shader
+	auto page = [] (const sf::Text& text)
+	{
+		return text.getFont() ? &text.getFont()->getTexture(text.getCharacterSize()) : nullptr;
+	};
+
+	const TextDraw& start = mTexts[first];
+	runStates = sf::RenderStates(start.states.blendMode, sf::Transform::Identity, page(*start.text), start.states.shader);
+
+	std::size_t end = first + 1;
+	while (end < mTexts.size() && page(*mTexts[end].text) == runStates.texture
+		&& mTexts[end].states.blendMode == runStates.blendMode && mTexts[end].states.shader == runStates.shader)
+		++end;
+
+	return end;
+}
+
+void SpriteBatch::reset()
+{
+	// Keep the vertex storage, so a steady scene stops allocating after the first frames
+	for (std::size_t i = 0; i < mBatchCount; ++i)
+		mBatches[i].vertices.clear();
+
+	mBatchCount = 0;
+	mUnderlays.clear();
+	mOverlays.clear();
+	mTexts.clear();
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include "TextureAtlas.hpp"
+
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/Graphics/RenderStates.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/Rect.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace sf
+{
+	class RenderTarget;
+	class Sprite;
+	class Text;
+}
+
+class SceneNode;
+class RenderFrame;
+
+//Collects the sprites of a layer into one quad array per texture and blend mode, submitted when the layer is flushed
+class SpriteBatch : private sf::NonCopyable
+{
+public:
+	SpriteBatch();
+
+	//Sprites whose texture was packed are drawn from its atlas page instead
+	void setAtlas(const TextureAtlas* atlas);
+	//Page and offset a node drawing its own vertices should use for texture, or null if it was not packed
+	const TextureAtlas::Region* findRegion(const sf::Texture* texture) const;
+
+	//Nodes whose bounds miss this rectangle are skipped with their children
+	void setCullRect(const sf::FloatRect& rect);
+	bool cull(const sf::FloatRect& bounds);
+
+	//Fraction of a tick the picture is between the previous and the current simulation state, 1 for the current one
+	void setInterpolation(float alpha);
+	float getInterpolation() const;
+
+	void begin();
+	void draw(const sf::Sprite& sprite, const sf::RenderStates& states);
+	//Nodes that draw themselves never split a batch: those submitted before the layer's first sprite are drawn under
+	//its batches, such as particles and bullets, the rest over them in submission order
+	void drawCustom(const SceneNode& node, const sf::RenderStates& states);
+	//Texts go over everything else in the layer, laid out into glyph quads so the texts sharing a font page,
+	//such as every aircraft's health display, cost one draw call together; text must live until the flush
+	void drawText(const sf::Text& text, const sf::RenderStates& states);
+	void flush(sf::RenderTarget& target);
+	//Same order as flush(target), but copied into the frame for a render thread
+	void flush(RenderFrame& frame);
+
+	std::size_t getDrawCallCount() const;
+	std::size_t getSpriteCount() const;
+	std::size_t getCulledCount() const;
+	std::size_t getVisibleCount() const;
+
+private:
+	struct Batch
+	{
+		sf::RenderStates states;
+		std::vector<sf::Vertex> vertices;
+	};
+
+	struct CustomDraw
+	{
+		const SceneNode* node;
+		sf::RenderStates states;
+	};
+
+	struct TextDraw
+	{
+		const sf::Text* text;
+		sf::RenderStates states;
+	};
+
+	Batch& findBatch(const sf::RenderStates& states);
+	//Texts from first on that can share a draw call with it; the states it is drawn with go in runStates
+	std::size_t findTextRunEnd(std::size_t first, sf::RenderStates& runStates) const;
+	void reset();
+
+private:
+	const TextureAtlas* mAtlas;
+	sf::FloatRect mCullRect;
+	bool mCulling;
+	float mInterpolation;
+
+	std::vector<Batch> mBatches;
+	std::size_t mBatchCount;
+	std::vector<CustomDraw> mUnderlays;
+	std::vector<CustomDraw> mOverlays;
+	std::vector<TextDraw> mTexts;
+	std::vector<sf::Vertex> mTextVertices;
+
+	std::size_t mDrawCalls;
+	std::size_t mSprites;
+	std::size_t mCulled;
+	std::size_t mVisible;
+};
@@ -1,4 +1,5 @@
 #include "SpriteNode.hpp"
+#include "SpriteBatch.hpp"
 #include "SFML/Graphics/RenderTarget.hpp"
 
 SpriteNode::SpriteNode(const sf::Texture& texture) : mSprite(texture)
@@ -9,7 +10,17 @@ SpriteNode::SpriteNode(const sf::Texture& texture, const sf::IntRect& textureRec
 {
 }
 
+sf::FloatRect SpriteNode::getBoundingRect() const
+{
+	return getWorldTransform().transformRect(mSprite.getGlobalBounds());
+}
+
 void SpriteNode::drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const
 {
 	target.draw(mSprite, states);
 }
+
+void SpriteNode::batchCurrent(SpriteBatch& batch, sf::RenderStates states) const
+{
+	batch.draw(mSprite, states);
+}
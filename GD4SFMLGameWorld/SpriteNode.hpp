@@ -8,8 +8,11 @@ public:
 	explicit SpriteNode(const sf::Texture& texture);
 	SpriteNode(const sf::Texture& texture, const sf::IntRect& textureRect);
 
+	virtual sf::FloatRect getBoundingRect() const;
+
 private:
 	virtual void drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const;
+	virtual void batchCurrent(SpriteBatch& batch, sf::RenderStates states) const;
 
 private:
 	sf::Sprite mSprite;
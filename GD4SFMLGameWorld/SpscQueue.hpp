@@ -0,0 +1,37 @@
+#pragma once
+#include <SFML/System/NonCopyable.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+//Bounded lock-free queue for exactly one producer thread and one consumer thread
+//Each side only writes its own index, so a push and a pop never wait on each other
+template<typename T, std::size_t Capacity>
+class SpscQueue : private sf::NonCopyable
+{
+public:
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+	SpscQueue();
+
+	//Producer side; false when full, the item is not queued
+	bool push(const T& item);
+	//Consumer side; false when empty
+	bool pop(T& item);
+
+	bool isEmpty() const;
+
+private:
+	std::array<T, Capacity> mItems;
+
+	// Both indices only ever grow; an index & (Capacity - 1) is its slot
+	// Padded a cache line apart, so the two threads do not invalidate each other's line on every item
+	// (padding rather than alignas, which the owner's plain new would not honour before C++17)
+	std::atomic<std::size_t> mHead;
+	char mPadding[64];
+	std::atomic<std::size_t> mTail;
+};
+
+#include "SpscQueue.inl"
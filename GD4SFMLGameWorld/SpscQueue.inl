@@ -0,0 +1,40 @@
+template<typename T, std::size_t Capacity>
+SpscQueue<T, Capacity>::SpscQueue()
+	: mItems()
+	, mHead(0)
+	, mPadding()
+	, mTail(0)
+{
+}
+
+template<typename T, std::size_t Capacity>
+bool SpscQueue<T, Capacity>::push(const T& item)
+{
+	std::size_t tail = mTail.load(std::memory_order_relaxed);
+	if (tail - mHead.load(std::memory_order_acquire) == Capacity)
+		return false;
+
+	// Release publishes the item together with the new tail
+	mItems[tail & (Capacity - 1)] = item;
+	mTail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+template<typename T, std::size_t Capacity>
+bool SpscQueue<T, Capacity>::pop(T& item)
+{
+	std::size_t head = mHead.load(std::memory_order_relaxed);
+	if (head == mTail.load(std::memory_order_acquire))
+		return false;
+
+	// The slot is handed back to the producer only after it has been read
+	item = mItems[head & (Capacity - 1)];
+	mHead.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+template<typename T, std::size_t Capacity>
+bool SpscQueue<T, Capacity>::isEmpty() const
+{
+	return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire);
+}
@@ -1,7 +1,7 @@
 #include "State.hpp"
 #include "StateStack.hpp"
 
-State::State(StateStack& stack, Context context) : mStack(&stack), mContext(context)
+State::State(StateStack& stack, Context context) : mStack(&stack), mContext(context), mIsUpdating(false), mInterpolation(1.f)
 {
 }
 
@@ -10,6 +10,11 @@ State::~State()
 }
 
 
+bool State::needsRealTime() const
+{
+	return false;
+}
+
 void State::requestStackPush(StateID stateID)
 {
 	mStack->pushState(stateID);
@@ -30,7 +35,12 @@ State::Context State::getContext() const
 	return mContext;
 }
 
-State::Context::Context(sf::RenderWindow& window, TextureHolder& textures, FontHolder& font, Player& player, Player2& player2, MusicPlayer& music, SoundPlayer& sounds) :
-	window(&window), textures(&textures), fonts(&font), player(&player), player2(&player2), music(&music), sounds(&sounds)
+float State::getInterpolation() const
+{
+	return mInterpolation;
+}
+
+State::Context::Context(sf::RenderWindow& window, TextureHolder& textures, FontHolder& font, Player& player, Player2& player2, MusicPlayer& music, SoundPlayer& sounds, Profiler& profiler, bool renderThread) :
+	window(&window), textures(&textures), fonts(&font), player(&player), player2(&player2), music(&music), sounds(&sounds), profiler(&profiler), renderThread(renderThread)
 {
 }
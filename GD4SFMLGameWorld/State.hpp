@@ -11,6 +11,7 @@
 
 class Player;
 class Player2;
+class Profiler;
 class StateStack;
 
 namespace sf
@@ -25,7 +26,7 @@ public:
 
 	struct Context
 	{
-		Context(sf::RenderWindow& window, TextureHolder& textures, FontHolder& font, Player& player, Player2& player2, MusicPlayer& music, SoundPlayer& sounds);
+		Context(sf::RenderWindow& window, TextureHolder& textures, FontHolder& font, Player& player, Player2& player2, MusicPlayer& music, SoundPlayer& sounds, Profiler& profiler, bool renderThread = false);
 
 		sf::RenderWindow* window;
 		TextureHolder* textures;
@@ -34,6 +35,9 @@ public:
 		Player2* player2;
 		MusicPlayer* music;
 		SoundPlayer* sounds;
+		Profiler* profiler;
+		//Game worlds draw on a render thread
+		bool renderThread;
 	};
 
 public:
@@ -45,6 +49,9 @@ public:
 	virtual void draw() = 0;
 	virtual bool update(sf::Time dt) = 0;
 	virtual bool handleEvent(const sf::Event& event) = 0;
+	//States that follow another machine's clock, such as a server's, need every tick on time: while one is on
+	//the stack the application neither dilates time nor drops ticks
+	virtual bool needsRealTime() const;
 
 protected:
 	void requestStackPush(StateID stateID);
@@ -52,8 +59,15 @@ protected:
 	void requestStackClear();
 
 	Context getContext() const;
+	//How far the picture is between the state before the last tick (0) and after it (1); 1 while the state is not updated
+	float getInterpolation() const;
 
 private:
+	// Set by the stack, which knows whether this state was updated on the last tick
+	friend class StateStack;
+
 	StateStack* mStack;
 	Context mContext;
+	bool mIsUpdating;
+	float mInterpolation;
 };
\ No newline at end of file
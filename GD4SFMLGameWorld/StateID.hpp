@@ -5,6 +5,7 @@ enum class StateID
 	Title,
 	Menu,
 	Game,
+	NetworkGame,
 	Pause,
 	Settings,
 	GameOver
@@ -12,8 +12,12 @@ StateStack::StateStack(State::Context context)
 void StateStack::update(sf::Time dt)
 {
 	//Iterate from top to bottom, stop as soon as update returns false
+	for (State::Ptr& state : mStack)
+		state->mIsUpdating = false;
+
 	for (auto itr = mStack.rbegin(); itr != mStack.rend(); ++itr)
 	{
+		(*itr)->mIsUpdating = true;
 		if (!(*itr)->update(dt))
 		{
 			break;
@@ -22,11 +26,12 @@ void StateStack::update(sf::Time dt)
 	applyPendingChanges();
 }
 
-void StateStack::draw()
+void StateStack::draw(float alpha)
 {
-	//Draw all active states from bottom to top
+	//Draw all active states from bottom to top; a paused state has not moved since its last tick and is drawn as it is
 	for (State::Ptr& state : mStack)
 	{
+		state->mInterpolation = state->mIsUpdating ? alpha : 1.f;
 		state->draw();
 	}
 }
@@ -64,6 +69,17 @@ bool StateStack::isEmpty() const
 	return mStack.empty();
 }
 
+bool StateStack::needsRealTime() const
+{
+	for (const State::Ptr& state : mStack)
+	{
+		if (state->needsRealTime())
+			return true;
+	}
+
+	return false;
+}
+
 State::Ptr StateStack::createState(StateID stateID)
 {
 	auto found = mFactories.find(stateID);
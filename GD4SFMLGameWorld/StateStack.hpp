@@ -26,7 +26,8 @@ public:
 	void registerState(StateID stateID);
 
 	void update(sf::Time dt);
-	void draw();
+	//alpha is the fraction of a tick since the last update; states below one that blocks updates ignore it
+	void draw(float alpha = 1.f);
 	void handleEvent(const sf::Event& event);
 
 	void pushState(StateID stateID);
@@ -34,6 +35,7 @@ public:
 	void clearStates();
 
 	bool isEmpty() const;
+	bool needsRealTime() const;
 
 private:
 	State::Ptr createState(StateID stateID);
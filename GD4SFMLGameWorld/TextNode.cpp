@@ -1,8 +1,11 @@
 #include "TextNode.hpp"
+#include "SpriteBatch.hpp"
 
 #include <SFML/Graphics/RenderTarget.hpp>
 
 TextNode::TextNode(const FontHolder& fonts, const std::string& text)
+	: mText()
+	, mNeedsLayout(false)
 {
 	mText.setFont(fonts.get(FontID::Main));
 	mText.setCharacterSize(20);
@@ -12,10 +15,26 @@ TextNode::TextNode(const FontHolder& fonts, const std::string& text)
 void TextNode::setString(const std::string& text)
 {
 	mText.setString(text);
-	centreOrigin(mText);
+	mNeedsLayout = true;
 }
 
 void TextNode::drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const
 {
+	layOut();
 	target.draw(mText, states);
 }
+
+void TextNode::batchCurrent(SpriteBatch& batch, sf::RenderStates states) const
+{
+	layOut();
+	batch.drawText(mText, states);
+}
+
+void TextNode::layOut() const
+{
+	if (!mNeedsLayout)
+		return;
+
+	centreOrigin(mText);
+	mNeedsLayout = false;
+}
@@ -14,7 +14,12 @@ public:
 
 private:
 	virtual void drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const;
+	virtual void batchCurrent(SpriteBatch& batch, sf::RenderStates states) const;
+	void layOut() const;
 
 private:
-	sf::Text mText;
+	// Laid out when drawn: measuring glyphs may load them into the shared font texture,
+	// which the threads updating entities must not touch
+	mutable sf::Text mText;
+	mutable bool mNeedsLayout;
 };
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "TextureAtlas.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace
+{
+	//Transparent gap between packed textures, so filtering never samples a neighbour
+	const unsigned int Padding = 2;
+	const unsigned int MaxPageSize = 2048;
+}
+
+TextureAtlas::TextureAtlas()
+	: mEntries()
+	, mPages()
+{
+}
+
+void TextureAtlas::add(const sf::Texture& source, const sf::Image& image)
+{
+	// Repeated textures rely on wrapping past their own edges, which a page cannot provide
+	assert(!source.isRepeated());
+	assert(mPages.empty());
+
+	Entry entry = { &source, image, 0, sf::Vector2u(), Region() };
+	mEntries.push_back(entry);
+}
+
+void TextureAtlas::build()
+{
+	if (mEntries.empty())
+		return;
+
+	const unsigned int pageWidth = std::min(MaxPageSize, sf::Texture::getMaximumSize());
+
+	// Shelf packing, tallest first: fill a row left to right, then open a new row or page
+	std::vector<std::size_t> order(mEntries.size());
+	for (std::size_t i = 0; i < order.size(); ++i)
+		order[i] = i;
+
+	std::sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs)
+	{
+		return mEntries[lhs].image.getSize().y > mEntries[rhs].image.getSize().y;
+	});
+
+	std::vector<sf::Vector2u> pageSizes(1);
+	sf::Vector2u cursor;
+	unsigned int shelfHeight = 0;
+
+	for (std::size_t i : order)
+	{
+		sf::Vector2u size = mEntries[i].image.getSize();
+		assert(size.x + Padding <= pageWidth && size.y + Padding <= pageWidth);
+
+		if (cursor.x + size.x + Padding > pageWidth)
+		{
+			cursor.x = 0;
+			cursor.y += shelfHeight;
+			shelfHeight = 0;
+		}
+
+		if (cursor.y + size.y + Padding > pageWidth)
+		{
+			pageSizes.push_back(sf::Vector2u());
+			cursor = sf::Vector2u();
+			shelfHeight = 0;
+		}
+
+		Entry& entry = mEntries[i];
+		entry.page = pageSizes.size() - 1;
+		entry.position = cursor;
+
+		cursor.x += size.x + Padding;
+		shelfHeight = std::max(shelfHeight, size.y + Padding);
+
+		sf::Vector2u& pageSize = pageSizes.back();
+		pageSize.x = std::max(pageSize.x, cursor.x);
+		pageSize.y = std::max(pageSize.y, cursor.y + shelfHeight);
+	}
+
+	// Compose each page on the CPU and upload it once
+	for (std::size_t page = 0; page < pageSizes.size(); ++page)
+	{
+		sf::Image pageImage;
+		pageImage.create(pageSizes[page].x, pageSizes[page].y, sf::Color::Transparent);
+
+		for (std::size_t i = 0; i < mEntries.size(); ++i)
+		{
+			if (mEntries[i].page == page)
+				pageImage.copy(mEntries[i].image, mEntries[i].position.x, mEntries[i].position.y);
+		}
+
+		std::unique_ptr<sf::Texture> texture(new sf::Texture());
+		if (!texture->loadFromImage(pageImage))
+			throw std::runtime_error("TextureAtlas::build - Failed to create an atlas page");
+
+		mPages.push_back(std::move(texture));
+	}
+
+	for (Entry& entry : mEntries)
+	{
+		entry.region.page = mPages[entry.page].get();
+		entry.region.offset = sf::Vector2f(static_cast<float>(entry.position.x), static_cast<float>(entry.position.y));
+		entry.region.size = entry.image.getSize();
+
+		// The pages hold the pixels now
+		entry.image = sf::Image();
+	}
+}
+
+const TextureAtlas::Region* TextureAtlas::find(const sf::Texture* source) const
+{
+	// A handful of entries, searched per batched sprite; cheaper than hashing
+	for (const Entry& entry : mEntries)
+	{
+		if (entry.source == source)
+			return mPages.empty() ? nullptr : &entry.region;
+	}
+
+	return nullptr;
+}
+
+std::size_t TextureAtlas::getPageCount() const
+{
+	return mPages.size();
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Image.hpp>
+
+#include <memory>
+#include <vector>
+
+//Packs small textures into shared pages at load time, so sprites using any of them can share one draw call
+class TextureAtlas : private sf::NonCopyable
+{
+public:
+	//Where a packed texture ended up: its page, the offset to add to its texture rects and the image's size
+	struct Region
+	{
+		const sf::Texture* page;
+		sf::Vector2f offset;
+		sf::Vector2u size;
+	};
+
+public:
+	TextureAtlas();
+
+	//source only identifies the texture sprites use; its pixels come from image, which is released once the pages are built
+	void add(const sf::Texture& source, const sf::Image& image);
+	void build();
+
+	const Region* find(const sf::Texture* source) const;
+	std::size_t getPageCount() const;
+
+private:
+	struct Entry
+	{
+		const sf::Texture* source;
+		sf::Image image;
+		std::size_t page;
+		sf::Vector2u position;
+		Region region;
+	};
+
+private:
+	std::vector<Entry> mEntries;
+	std::vector<std::unique_ptr<sf::Texture>> mPages;
+};
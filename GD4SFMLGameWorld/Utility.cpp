@@ -2,6 +2,8 @@
 
 #include <SFML/Graphics/Sprite.hpp>
 #include <SFML/Graphics/Text.hpp>
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/Vertex.hpp>
 
 #include <random>
 #include <cmath>
@@ -12,8 +14,7 @@ namespace
 {
 	std::default_random_engine createRandomEngine()
 	{
-		auto seed = static_cast<unsigned long>(std::time(nullptr));
-		return std::default_random_engine(seed);
+		return std::default_random_engine(createRandomSeed());
 	}
 
 	auto RandomEngine = createRandomEngine();
@@ -33,6 +34,80 @@ void centreOrigin(sf::Text& text)
 	text.setOrigin(std::floor(bounds.left + bounds.width / 2.f), std::floor(bounds.top + bounds.height / 2.f));
 }
 
+void appendGlyphQuads(std::vector<sf::Vertex>& vertices, const sf::Text& text, const sf::Transform& transform)
+{
+	const sf::Font* font = text.getFont();
+	if (!font)
+		return;
+
+	assert(text.getOutlineThickness() == 0.f);
+	assert((text.getStyle() & ~sf::Text::Bold) == 0);
+
+	// Same layout as sf::Text::ensureGeometryUpdate
+	const unsigned int size = text.getCharacterSize();
+	const bool bold = (text.getStyle() & sf::Text::Bold) != 0;
+	const sf::Color color = text.getFillColor();
+	const sf::Transform combined = transform * text.getTransform();
+
+	float whitespaceWidth = font->getGlyph(L' ', size, bold).advance;
+	float letterSpacing = (whitespaceWidth / 3.f) * (text.getLetterSpacing() - 1.f);
+	whitespaceWidth += letterSpacing;
+	float lineSpacing = font->getLineSpacing(size) * text.getLineSpacing();
+
+	float x = 0.f;
+	float y = static_cast<float>(size);
+	sf::Uint32 previous = 0;
+
+	const sf::String& string = text.getString();
+	for (std::size_t i = 0; i < string.getSize(); ++i)
+	{
+		sf::Uint32 current = string[i];
+		if (current == L'\r')
+			continue;
+
+		x += font->getKerning(previous, current, size);
+		previous = current;
+
+		if (current == L' ')
+		{
+			x += whitespaceWidth;
+			continue;
+		}
+		if (current == L'\t')
+		{
+			x += whitespaceWidth * 4.f;
+			continue;
+		}
+		if (current == L'\n')
+		{
+			y += lineSpacing;
+			x = 0.f;
+			continue;
+		}
+
+		const sf::Glyph& glyph = font->getGlyph(current, size, bold);
+
+		// sf::Text pads every glyph by a pixel so filtering does not cut its edges
+		const float padding = 1.f;
+		float left = x + glyph.bounds.left - padding;
+		float top = y + glyph.bounds.top - padding;
+		float right = x + glyph.bounds.left + glyph.bounds.width + padding;
+		float bottom = y + glyph.bounds.top + glyph.bounds.height + padding;
+
+		float u1 = static_cast<float>(glyph.textureRect.left) - padding;
+		float v1 = static_cast<float>(glyph.textureRect.top) - padding;
+		float u2 = static_cast<float>(glyph.textureRect.left + glyph.textureRect.width) + padding;
+		float v2 = static_cast<float>(glyph.textureRect.top + glyph.textureRect.height) + padding;
+
+		vertices.push_back(sf::Vertex(combined.transformPoint(left, top), color, sf::Vector2f(u1, v1)));
+		vertices.push_back(sf::Vertex(combined.transformPoint(right, top), color, sf::Vector2f(u2, v1)));
+		vertices.push_back(sf::Vertex(combined.transformPoint(right, bottom), color, sf::Vector2f(u2, v2)));
+		vertices.push_back(sf::Vertex(combined.transformPoint(left, bottom), color, sf::Vector2f(u1, v2)));
+
+		x += glyph.advance + letterSpacing;
+	}
+}
+
 float toDegree(float radian)
 {
 	return 180.f / 3.141592653589793238462643383f * radian;
@@ -60,6 +135,17 @@ int randomInt(int exclusiveMax)
 	return distr(RandomEngine);
 }
 
+unsigned int createRandomSeed()
+{
+	return static_cast<unsigned int>(std::time(nullptr));
+}
+
+void seedRandomEngine(unsigned int seed)
+{
+	//Reseeding with a recorded seed replays the same random sequence
+	RandomEngine.seed(seed);
+}
+
 void centreOrigin(Animation& animation)
 {
 	sf::FloatRect bounds = animation.getLocalBounds();
@@ -1,11 +1,14 @@
 #pragma once
 #include <sstream>
+#include <vector>
 #include <SFML/System/Vector2.hpp>
 #include "Animation.hpp"
 namespace sf
 {
 	class Sprite;
 	class Text;
+	class Transform;
+	class Vertex;
 }
 
 
@@ -17,6 +20,10 @@ void centreOrigin(sf::Sprite& sprite);
 void centreOrigin(sf::Text& text);
 void centreOrigin(Animation& animation);
 
+// The quads sf::Text would draw for a plain text (no outline, underline, strike-through or italics), transformed
+// and appended, so many texts on one font page can share a draw call; loads missing glyphs into the font
+void appendGlyphQuads(std::vector<sf::Vertex>& vertices, const sf::Text& text, const sf::Transform& transform);
+
 // Degree/radian conversion
 float toDegree(float radian);
 float toRadian(float degree);
@@ -27,5 +34,7 @@ sf::Vector2f unitVector(sf::Vector2f vector);
 
 // Random number generation
 int	randomInt(int exclusiveMax);
+unsigned int createRandomSeed();
+void seedRandomEngine(unsigned int seed);
 
 #include "Utility.inl"
\ No newline at end of file
@@ -1,19 +1,55 @@
 #include "World.hpp"
 #include "ParticleID.hpp"
 #include "ParticleNode.hpp"
+#include "BulletSystem.hpp"
 #include <SFML/Graphics/RenderWindow.hpp>
 
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <limits>
+
 //Eoghan - D00187992
 
+namespace
+{
+	// Commands that only make noise or smoke; dropped while resimulating
+	const unsigned int CosmeticCategories = static_cast<int>(CategoryID::SoundEffect) | static_cast<int>(CategoryID::ParticleSystem);
+
+	template <typename State>
+	bool byIdentifier(const State& lhs, const State& rhs)
+	{
+		return lhs.identifier < rhs.identifier;
+	}
+}
+
 World::World(sf::RenderTarget& outputTarget, FontHolder& fonts, SoundPlayer& sounds)
+	: World(&outputTarget, &fonts, &sounds, outputTarget.getDefaultView())
+{
+}
+
+World::World(sf::Vector2f viewSize)
+	: World(nullptr, nullptr, nullptr, sf::View(sf::FloatRect(0.f, 0.f, viewSize.x, viewSize.y)))
+{
+}
+
+World::World(sf::RenderTarget* outputTarget, FontHolder* fonts, SoundPlayer* sounds, const sf::View& camera)
 	: mTarget(outputTarget)
 	, mSceneTexture()
-	, mCamera(outputTarget.getDefaultView())
+	, mCamera(camera)
+	, mPreviousCameraCenter(camera.getCenter())
 	, mFonts(fonts)
 	, mSounds(sounds)
 	, mTextures()
+	, mTextureAtlas()
+	, mProjectilePool(sizeof(Projectile), 256)
+	, mIdentifiers()
+	, mCategoryRegistry()
 	, mSceneGraph()
 	, mSceneLayers()
+	, mCommandQueue()
+	, mJobSystem()
+	, mChunkQueues()
 	, mWorldBounds(0.f, 0.f, 5000.f, mCamera.getSize().x)
 	, mSpawnPosition(mCamera.getSize().x / 2.f, mWorldBounds.height - mCamera.getSize().y / 2.f)
 	, mSpawnPosition2(mCamera.getSize().x / 2.f, mWorldBounds.height - mCamera.getSize().y / 3.f)
@@ -21,62 +57,255 @@ World::World(sf::RenderTarget& outputTarget, FontHolder& fonts, SoundPlayer& sou
 	, mPlayerAircraft(nullptr)
 	, mPlayer2Aircraft(nullptr)
 	, mEnemySpawnPoints()
+	, mSpawnCursor(0)
 	, mActiveEnemies()
+	, mAircraft()
+	, mIsReplica(false)
+	, mIsResimulating(false)
+	, mParticleNodes()
+	, mBulletSystem(nullptr)
+	, mEntities()
+	, mDetached()
+	, mCollisionMatrix()
+	, mCollisionGrid(128.f)
+	, mCollisionContacts()
+	, mChunkContacts()
+	, mSpriteBatch()
+	, mBloomEffect()
+	, mRenderThread()
+	, mProfiler(nullptr)
 {
-	mSceneTexture.create(mTarget.getSize().x, mTarget.getSize().y);
+	// Render targets and shaders need a GL context, which headless worlds do not have
+	if (!isHeadless())
+	{
+		mSceneTexture.create(mTarget->getSize().x, mTarget->getSize().y);
+		mBloomEffect.reset(new BloomEffect());
+	}
+
 	loadTextures();
+	mSceneGraph.setCategoryRegistry(&mCategoryRegistry);
 	buildScene();
+	setupCollisionResponses();
 
 	// Prepare the view
 	mCamera.setCenter(mSpawnPosition);
+	mPreviousCameraCenter = mCamera.getCenter();
 }
 
 void World::update(sf::Time dt)
 {
+	// Drawing blends from here to where this tick leaves everything; a headless world is never drawn
+	if (!isHeadless())
+	{
+		mPreviousCameraCenter = mCamera.getCenter();
+		mSceneGraph.storePreviousTransforms();
+	}
+
 	// Scroll the world, reset player velocity
 	mCamera.move(-mScrollSpeed * dt.asSeconds(), 0.f);
 
 	mPlayerAircraft->setVelocity(-mScrollSpeed * dt.asSeconds(), 0.f);
 	mPlayer2Aircraft->setVelocity(-mScrollSpeed * dt.asSeconds(), 0.f);
-	// Setup commands to destroy entities, and guide missiles
-	destroyEntitiesOutsideView();
-	//guideMissiles();
 
-	// Forward commands to scene graph, adapt velocity (scrolling, diagonal correction)
-	while (!mCommandQueue.isEmpty())
-		mSceneGraph.onCommand(mCommandQueue.pop(), dt);
+	{
+		Profiler::Scope scope(mProfiler, ProfileSectionID::Commands);
+
+		// Setup commands to destroy entities, and guide missiles
+		destroyEntitiesOutsideView();
+		//guideMissiles();
+
+		// Forward commands to the nodes registered for their category, adapt velocity (scrolling, diagonal correction)
+		dispatchCommands(dt);
+	}
 	adaptPlayerVelocity();
 	adaptPlayer2Velocity();
-	// Collision detection and response (may destroy entities)
-	handleCollisions();
+
+	// Collision detection and response (may destroy entities); a replica gets the outcome from the server
+	if (!mIsReplica)
+	{
+		Profiler::Scope scope(mProfiler, ProfileSectionID::Collisions);
+		handleCollisions();
+	}
 
 	// Remove all destroyed entities, create new ones
-	mSceneGraph.removeWrecks();
-	spawnEnemies();
+	{
+		Profiler::Scope scope(mProfiler, ProfileSectionID::RemoveWrecks);
+		mSceneGraph.removeWrecks();
+	}
+	if (!mIsReplica)
+	{
+		Profiler::Scope scope(mProfiler, ProfileSectionID::SpawnEnemies);
+		spawnEnemies();
+	}
 
 	// Regular update step, adapt position (correct if outside view)
-	mSceneGraph.update(dt, mCommandQueue);
-	adaptPlayerPosition();
-	adaptPlayer2Position();
+	{
+		Profiler::Scope scope(mProfiler, ProfileSectionID::SceneUpdate);
+		if (mJobSystem)
+			mSceneGraph.update(dt, mCommandQueue, *mJobSystem, mChunkQueues);
+		else
+			mSceneGraph.update(dt, mCommandQueue);
+		adaptPlayerPosition();
+		adaptPlayer2Position();
+
+		// Refresh cached world transforms once, so later lookups this frame are a plain read
+		mSceneGraph.updateWorldTransforms();
+	}
+
+	// Deliver what the entities just issued (shots, sounds), so no command is left pending between ticks
+	{
+		Profiler::Scope scope(mProfiler, ProfileSectionID::Commands);
+		dispatchCommands(dt);
+	}
 
-	updateSounds();
+	if (!mIsResimulating)
+	{
+		Profiler::Scope scope(mProfiler, ProfileSectionID::Sounds);
+		updateSounds();
+	}
+
+	if (mProfiler)
+	{
+		mProfiler->setCounter("Projectiles pooled", mProjectilePool.getInUse());
+		mProfiler->setCounter("Projectile pool misses", mProjectilePool.getMisses());
+		mProfiler->setCounter("Projectile pool high-water mark", mProjectilePool.getHighWaterMark());
+		mProfiler->setCounter("Command queue allocations", mCommandQueue.getAllocationCount());
+		if (mJobSystem)
+			mProfiler->setCounter("Update jobs stolen", mJobSystem->takeStealCount());
+	}
 }
 
-void World::draw()
+void World::draw(float alpha)
 {
-	if (PostEffect::isSupported())
+	if (isHeadless())
+		return;
+
+	Profiler::Scope scope(mProfiler, ProfileSectionID::Draw);
+	sf::View camera = getInterpolatedCamera(alpha);
+
+	if (mRenderThread)
+	{
+		// Hand this frame over, then show the previous one, which submit() waited for
+		recordScene(mRenderThread->getFrame(), camera, alpha);
+		mRenderThread->submit();
+
+		const sf::Texture* picture = mRenderThread->getPicture();
+		if (picture)
+		{
+			mTarget->setView(mTarget->getDefaultView());
+			mTarget->draw(sf::Sprite(*picture));
+		}
+	}
+	else if (PostEffect::isSupported())
 	{
 		mSceneTexture.clear();
-		mSceneTexture.setView(mCamera);
-		mSceneTexture.draw(mSceneGraph);
+		drawScene(mSceneTexture, camera, alpha);
 		mSceneTexture.display();
-		mBloomEffect.apply(mSceneTexture, mTarget);
+		mBloomEffect->apply(mSceneTexture, *mTarget);
 	}
 	else
 	{
-		mTarget.setView(mCamera);
-		mTarget.draw(mSceneGraph);
+		drawScene(*mTarget, camera, alpha);
 	}
+
+	if (mProfiler)
+	{
+		mProfiler->setCounter("Particle upload bytes", getParticleUploadBytes());
+		mProfiler->setCounter("Draw calls", mSpriteBatch.getDrawCallCount());
+		mProfiler->setCounter("Batched sprites", mSpriteBatch.getSpriteCount());
+		mProfiler->setCounter("Culled nodes", mSpriteBatch.getCulledCount());
+		mProfiler->setCounter("Visible nodes", mSpriteBatch.getVisibleCount());
+
+		if (mRenderThread)
+		{
+			mProfiler->setCounter("Render thread (us)", static_cast<std::size_t>(mRenderThread->getRenderTime().asMicroseconds()));
+			mProfiler->setCounter("Render wait (us)", static_cast<std::size_t>(mRenderThread->getWaitTime().asMicroseconds()));
+		}
+	}
+}
+
+sf::View World::getInterpolatedCamera(float alpha) const
+{
+	sf::View camera = mCamera;
+	camera.setCenter(mPreviousCameraCenter + (mCamera.getCenter() - mPreviousCameraCenter) * alpha);
+	return camera;
+}
+
+void World::beginBatch(float alpha)
+{
+	// Margin covers explosions, which are larger than the aircraft bounds
+	const float cullMargin = 128.f;
+	sf::FloatRect cullRect = getViewBounds();
+	cullRect.left -= cullMargin;
+	cullRect.top -= cullMargin;
+	cullRect.width += 2.f * cullMargin;
+	cullRect.height += 2.f * cullMargin;
+	mSpriteBatch.setCullRect(cullRect);
+	mSpriteBatch.setInterpolation(alpha);
+
+	mSpriteBatch.begin();
+}
+
+void World::drawScene(sf::RenderTarget& target, const sf::View& camera, float alpha)
+{
+	target.setView(camera);
+	beginBatch(alpha);
+
+	// Each layer is flushed before the next one, so batching never moves a sprite across layers
+	for (SceneNode* layer : mSceneLayers)
+	{
+		layer->drawBatched(mSpriteBatch, sf::RenderStates::Default);
+		mSpriteBatch.flush(target);
+	}
+}
+
+void World::recordScene(RenderFrame& frame, const sf::View& camera, float alpha)
+{
+	beginBatch(alpha);
+	frame.clear(camera);
+
+	for (SceneNode* layer : mSceneLayers)
+	{
+		layer->drawBatched(mSpriteBatch, sf::RenderStates::Default);
+		mSpriteBatch.flush(frame);
+	}
+}
+
+void World::dispatchCommands(sf::Time dt)
+{
+	while (!mCommandQueue.isEmpty())
+	{
+		Command command = mCommandQueue.pop();
+
+		// Those ticks were already heard and seen
+		if (mIsResimulating && (command.category & CosmeticCategories))
+			continue;
+
+		mCategoryRegistry.dispatch(command, dt);
+	}
+}
+
+void World::setWorkerThreads(std::size_t count)
+{
+	if (count == getWorkerThreads())
+		return;
+
+	mJobSystem.reset();
+	mChunkQueues.clear();
+	mChunkContacts.clear();
+	if (count == 0)
+		return;
+
+	// A few chunks per thread, so a thread that drew the bullets or a crowded cell does not hold up the rest
+	const std::size_t ChunksPerThread = 4;
+	mJobSystem.reset(new JobSystem(count));
+	mChunkQueues.resize(mJobSystem->getThreadCount() * ChunksPerThread);
+	mChunkContacts.resize(mJobSystem->getThreadCount() * ChunksPerThread);
+}
+
+std::size_t World::getWorkerThreads() const
+{
+	return mJobSystem ? mJobSystem->getThreadCount() - 1 : 0;
 }
 
 CommandQueue& World::getCommandQueue()
@@ -106,113 +335,519 @@ bool World::hasPlayer2ReachedEnd() const
 
 void World::updateSounds()
 {
+	if (!mSounds)
+		return;
+
 	//Set the listener to the player position
-	mSounds.setListenPosition(mPlayerAircraft->getWorldPosition());
-	mSounds.setListenPosition(mPlayer2Aircraft->getWorldPosition());
+	mSounds->setListenPosition(mPlayerAircraft->getWorldPosition());
+	mSounds->setListenPosition(mPlayer2Aircraft->getWorldPosition());
 	//Remove unused sounds
-	mSounds.removeStoppedSounds();
+	mSounds->removeStoppedSounds();
 
 }
 
-void World::loadTextures()
+void World::setProfiler(Profiler* profiler)
 {
-	mTextures.load(TextureID::Entities, "Media/Textures/Entities.png");
-	mTextures.load(TextureID::Enemy, "Media/Textures/Enemy.png");
-	mTextures.load(TextureID::TitleScreen, "Media/Textures/TitleScreen.png");
-	mTextures.load(TextureID::Player, "Media/Textures/Player.png");
-	mTextures.load(TextureID::Player2, "Media/Textures/Player2.png");
-	mTextures.load(TextureID::Explosion, "Media/Textures/Explosion.png");
-	mTextures.load(TextureID::Particle, "Media/Textures/Particle.png");
-	mTextures.load(TextureID::FinishLine, "Media/Textures/FinishLine.png");
+	mProfiler = profiler;
+
+	if (mBloomEffect)
+		mBloomEffect->setProfiler(profiler);
+}
+
+void World::setRenderThread(bool enabled)
+{
+	if (isHeadless())
+		return;
+
+	mRenderThread.reset(enabled ? new RenderThread(mTarget->getSize()) : nullptr);
 }
 
-bool matchesCategories(SceneNode::Pair& colliders, CategoryID type1, CategoryID type2)
+bool World::hasRenderThread() const
 {
-	unsigned int category1 = colliders.first->getCategory();
-	unsigned int category2 = colliders.second->getCategory();
+	return mRenderThread != nullptr;
+}
 
-	// Make sure first pair entry has category type1 and second has type2
-	if (((static_cast<int>(type1))& category1) && ((static_cast<int>(type2))& category2))
+bool World::isHeadless() const
+{
+	return mTarget == nullptr;
+}
+
+void World::setReplica(bool replica)
+{
+	mIsReplica = replica;
+}
+
+bool World::isReplica() const
+{
+	return mIsReplica;
+}
+
+void World::captureSnapshot(WorldSnapshot& snapshot)
+{
+	collectAircraft();
+
+	// Exploding aircraft are left out, so the replicas destroy them as well
+	snapshot.aircraft.clear();
+	for (Aircraft* aircraft : mAircraft)
 	{
-		return true;
+		if (aircraft->isDestroyed())
+			continue;
+
+		AircraftSnapshot state;
+		state.identifier = aircraft->getIdentifier();
+		state.type = aircraft->getType();
+		state.position = quantizeVector(aircraft->getPosition());
+		state.velocity = quantizeVector(aircraft->getVelocity());
+		state.hitpoints = aircraft->getHitpoints();
+		state.fireRateLevel = aircraft->getFireRateLevel();
+		state.spreadLevel = aircraft->getSpreadLevel();
+		state.missileAmmo = aircraft->getMissileAmmo();
+		snapshot.aircraft.push_back(state);
 	}
-	else if (((static_cast<int>(type1))& category2) && ((static_cast<int>(type2))& category1))
+
+	// Missiles are entities, bullets live in the bullet system; both end up in one list
+	snapshot.projectiles.clear();
+	snapshot.pickups.clear();
+
+	Command projectileCollector;
+	projectileCollector.category = static_cast<int>(CategoryID::Projectile);
+	projectileCollector.action = derivedAction<Projectile>([&snapshot](Projectile& projectile, sf::Time)
 	{
-		std::swap(colliders.first, colliders.second);
-		return true;
-	}
-	else
+		if (projectile.isDestroyed())
+			return;
+
+		ProjectileSnapshot state;
+		state.identifier = projectile.getIdentifier();
+		state.type = projectile.getType();
+		state.position = quantizeVector(projectile.getPosition());
+		state.velocity = quantizeVector(projectile.getVelocity());
+		snapshot.projectiles.push_back(state);
+	});
+
+	Command bulletCollector;
+	bulletCollector.category = static_cast<int>(CategoryID::BulletSystem);
+	bulletCollector.action = derivedAction<BulletSystem>([&snapshot](BulletSystem& bullets, sf::Time)
 	{
-		return false;
-	}
+		for (std::size_t i = 0; i < bullets.getBulletCount(); ++i)
+		{
+			ProjectileSnapshot state;
+			state.identifier = bullets.getIdentifier(i);
+			state.type = bullets.getType(i);
+			state.position = quantizeVector(bullets.getPosition(i));
+			state.velocity = quantizeVector(bullets.getVelocity(i));
+			snapshot.projectiles.push_back(state);
+		}
+	});
+
+	Command pickupCollector;
+	pickupCollector.category = static_cast<int>(CategoryID::Pickup);
+	pickupCollector.action = derivedAction<Pickup>([&snapshot](Pickup& pickup, sf::Time)
+	{
+		if (pickup.isDestroyed())
+			return;
+
+		PickupSnapshot state;
+		state.identifier = pickup.getIdentifier();
+		state.type = pickup.getType();
+		state.position = quantizeVector(pickup.getPosition());
+		snapshot.pickups.push_back(state);
+	});
+
+	mCategoryRegistry.dispatch(projectileCollector, sf::Time::Zero);
+	mCategoryRegistry.dispatch(bulletCollector, sf::Time::Zero);
+	mCategoryRegistry.dispatch(pickupCollector, sf::Time::Zero);
+
+	auto byIdentifier = [](const auto& lhs, const auto& rhs) { return lhs.identifier < rhs.identifier; };
+	std::sort(snapshot.aircraft.begin(), snapshot.aircraft.end(), byIdentifier);
+	std::sort(snapshot.projectiles.begin(), snapshot.projectiles.end(), byIdentifier);
+	std::sort(snapshot.pickups.begin(), snapshot.pickups.end(), byIdentifier);
+
+	snapshot.spawnCursor = static_cast<unsigned int>(mSpawnCursor);
 }
 
-void World::handleCollisions()
+void World::applySnapshot(const WorldSnapshot& snapshot, unsigned int predictedIdentifier, sf::Time latency)
 {
-	std::set<SceneNode::Pair> collisionPairs;
-	mSceneGraph.checkSceneCollision(mSceneGraph, collisionPairs);
+	// Both players exist on each end from the start; adopt the server's identifiers on first contact
+	for (const AircraftSnapshot& state : snapshot.aircraft)
+	{
+		if (state.type == AircraftID::Player)
+			mPlayerAircraft->setIdentifier(state.identifier);
+		else if (state.type == AircraftID::Player2)
+			mPlayer2Aircraft->setIdentifier(state.identifier);
+	}
+
+	collectAircraft();
 
-	for (SceneNode::Pair pair : collisionPairs)
+	for (Aircraft* aircraft : mAircraft)
 	{
-		if (matchesCategories(pair, CategoryID::PlayerAircraft, CategoryID::EnemyAircraft))
+		if (aircraft->isDestroyed())
+			continue;
+
+		const AircraftSnapshot* state = findAircraft(snapshot, aircraft->getIdentifier());
+		if (!state)
 		{
-			auto& player = static_cast<Aircraft&>(*pair.first);
-			auto& enemy = static_cast<Aircraft&>(*pair.second);
+			aircraft->destroy();
+			continue;
+		}
 
-			// Collision: Player damage = enemy's remaining HP
-			player.damage(enemy.getHitpoints());
-			enemy.destroy();
+		int hitpoints = aircraft->getHitpoints();
+		if (state->hitpoints > hitpoints)
+			aircraft->repair(state->hitpoints - hitpoints);
+		else if (state->hitpoints < hitpoints)
+			aircraft->damage(hitpoints - state->hitpoints);
+
+		aircraft->setWeaponState(state->fireRateLevel, state->spreadLevel, state->missileAmmo);
+
+		if (aircraft->getIdentifier() != predictedIdentifier)
+		{
+			aircraft->setPosition(state->position + state->velocity * latency.asSeconds());
+			aircraft->setVelocity(state->velocity);
 		}
+	}
 
-		if (matchesCategories(pair, CategoryID::Player2Aircraft, CategoryID::EnemyAircraft))
+	// Enemies the server spawned since the last snapshot
+	for (const AircraftSnapshot& state : snapshot.aircraft)
+	{
+		auto found = std::find_if(mAircraft.begin(), mAircraft.end(), [&](Aircraft* aircraft)
 		{
-			auto& player2 = static_cast<Aircraft&>(*pair.first);
-			auto& enemy = static_cast<Aircraft&>(*pair.second);
+			return aircraft->getIdentifier() == state.identifier;
+		});
 
-			// Collision: Player damage = enemy's remaining HP
-			player2.damage(enemy.getHitpoints());
-			enemy.destroy();
-		}
+		if (state.type != AircraftID::Enemy || found != mAircraft.end())
+			continue;
+
+		std::unique_ptr<Aircraft> enemy(new Aircraft(state.type, mTextures, mFonts, mProjectilePool, mIdentifiers));
+		enemy->setIdentifier(state.identifier);
+		enemy->setPosition(state.position + state.velocity * latency.asSeconds());
+		enemy->setRotation(270.f);
+		enemy->setVelocity(state.velocity);
+		if (state.hitpoints < enemy->getHitpoints())
+			enemy->damage(enemy->getHitpoints() - state.hitpoints);
+		enemy->setWeaponState(state.fireRateLevel, state.spreadLevel, state.missileAmmo);
+
+		mSceneLayers[static_cast<int>(LayerID::UpperAir)]->attachChild(std::move(enemy));
+	}
+
+	mSceneGraph.updateWorldTransforms();
+}
+
+Aircraft* World::getAircraft(unsigned int identifier)
+{
+	collectAircraft();
+
+	for (Aircraft* aircraft : mAircraft)
+	{
+		if (aircraft->getIdentifier() == identifier)
+			return aircraft;
+	}
+
+	return nullptr;
+}
 
-		else if (matchesCategories(pair, CategoryID::PlayerAircraft, CategoryID::Pickup))
+void World::saveState(WorldState& state)
+{
+	state.cameraCenter = mCamera.getCenter();
+	state.spawnCursor = mSpawnCursor;
+	state.lastIdentifier = mIdentifiers.getLast();
+	state.aircraft.clear();
+	state.projectiles.clear();
+	state.pickups.clear();
+
+	Command aircraftSaver;
+	aircraftSaver.category = static_cast<int>(CategoryID::Aircraft);
+	aircraftSaver.action = derivedAction<Aircraft>([&state](Aircraft& aircraft, sf::Time)
+	{
+		state.aircraft.emplace_back();
+		aircraft.saveState(state.aircraft.back());
+	});
+
+	Command projectileSaver;
+	projectileSaver.category = static_cast<int>(CategoryID::Projectile);
+	projectileSaver.action = derivedAction<Projectile>([&state](Projectile& projectile, sf::Time)
+	{
+		state.projectiles.emplace_back();
+		projectile.saveState(state.projectiles.back());
+	});
+
+	Command pickupSaver;
+	pickupSaver.category = static_cast<int>(CategoryID::Pickup);
+	pickupSaver.action = derivedAction<Pickup>([&state](Pickup& pickup, sf::Time)
+	{
+		state.pickups.emplace_back();
+		pickup.saveState(state.pickups.back());
+	});
+
+	mCategoryRegistry.dispatch(aircraftSaver, sf::Time::Zero);
+	mCategoryRegistry.dispatch(projectileSaver, sf::Time::Zero);
+	mCategoryRegistry.dispatch(pickupSaver, sf::Time::Zero);
+
+	// Each category is already in attach order; only the players and enemies of the aircraft list need merging
+	std::sort(state.aircraft.begin(), state.aircraft.end(), byIdentifier<Aircraft::State>);
+	std::sort(state.projectiles.begin(), state.projectiles.end(), byIdentifier<Projectile::State>);
+	std::sort(state.pickups.begin(), state.pickups.end(), byIdentifier<Pickup::State>);
+
+	mBulletSystem->saveState(state.bullets);
+}
+
+void World::restoreState(const WorldState& state)
+{
+	// Commands are all delivered within update(), so none can refer to an entity about to be dropped
+	assert(mCommandQueue.isEmpty());
+
+	mCamera.setCenter(state.cameraCenter);
+	mSpawnCursor = state.spawnCursor;
+	mBulletSystem->restoreState(state.bullets);
+
+	// Take every entity out of the scene; the saved ones go back in identifier order, which is the order they were
+	// first attached in, so the scene updates and collides them in the same order as before the rollback
+	collectEntities();
+	mDetached.clear();
+	for (Entity* entity : mEntities)
+	{
+		LayerID layer = (entity->getCategory() & static_cast<int>(CategoryID::Aircraft)) ? LayerID::UpperAir : LayerID::LowerAir;
+		mDetached.emplace_back(entity->getIdentifier(), mSceneLayers[static_cast<int>(layer)]->detachChild(*entity));
+	}
+
+	std::sort(mDetached.begin(), mDetached.end(), [](const auto& lhs, const auto& rhs)
+	{
+		return lhs.first < rhs.first;
+	});
+
+	// Entities destroyed since the saved tick are built again; the constructors allocate identifiers, reset below
+	for (const Aircraft::State& saved : state.aircraft)
+	{
+		SceneNode::Ptr node = takeDetached(saved.identifier);
+		if (!node)
+			node.reset(new Aircraft(saved.type, mTextures, mFonts, mProjectilePool, mIdentifiers));
+
+		Aircraft& aircraft = static_cast<Aircraft&>(*node);
+		aircraft.restoreState(saved);
+
+		if (saved.type == AircraftID::Player)
+			mPlayerAircraft = &aircraft;
+		else if (saved.type == AircraftID::Player2)
+			mPlayer2Aircraft = &aircraft;
+
+		mSceneLayers[static_cast<int>(LayerID::UpperAir)]->attachChild(std::move(node));
+	}
+
+	// Missiles and pickups share the air layer, so their lists are merged
+	std::size_t projectile = 0;
+	std::size_t pickup = 0;
+	while (projectile < state.projectiles.size() || pickup < state.pickups.size())
+	{
+		bool nextIsProjectile = pickup == state.pickups.size()
+			|| (projectile < state.projectiles.size() && state.projectiles[projectile].identifier < state.pickups[pickup].identifier);
+
+		SceneNode::Ptr node;
+		if (nextIsProjectile)
 		{
-			auto& player = static_cast<Aircraft&>(*pair.first);
-			auto& pickup = static_cast<Pickup&>(*pair.second);
+			const Projectile::State& saved = state.projectiles[projectile++];
+			node = takeDetached(saved.identifier);
+			if (!node)
+				node.reset(new (mProjectilePool) Projectile(saved.type, mTextures, mIdentifiers));
 
-			// Apply pickup effect to player, destroy projectile
-			pickup.apply(player);
-			player.playerLocalSound(mCommandQueue, SoundEffectID::CollectPickup);
-			pickup.destroy();
+			static_cast<Projectile&>(*node).restoreState(saved);
 		}
-
-		else if (matchesCategories(pair, CategoryID::Player2Aircraft, CategoryID::Pickup))
+		else
 		{
-			auto& player2 = static_cast<Aircraft&>(*pair.first);
-			auto& pickup = static_cast<Pickup&>(*pair.second);
+			const Pickup::State& saved = state.pickups[pickup++];
+			node = takeDetached(saved.identifier);
+			if (!node)
+				node.reset(new Pickup(saved.type, mTextures, mIdentifiers));
 
-			// Apply pickup effect to player, destroy projectile
-			pickup.apply(player2);
-			player2.playerLocalSound(mCommandQueue, SoundEffectID::CollectPickup);
-			pickup.destroy();
+			static_cast<Pickup&>(*node).restoreState(saved);
 		}
 
-		else if (matchesCategories(pair, CategoryID::EnemyAircraft, CategoryID::AlliedProjectile)
-			|| matchesCategories(pair, CategoryID::PlayerAircraft, CategoryID::EnemyProjectile)
-			|| matchesCategories(pair, CategoryID::Player2Aircraft, CategoryID::EnemyProjectile))
-		{
-			auto& aircraft = static_cast<Aircraft&>(*pair.first);
-			auto& projectile = static_cast<Projectile&>(*pair.second);
+		mSceneLayers[static_cast<int>(LayerID::LowerAir)]->attachChild(std::move(node));
+	}
 
-			//Apply projectile damage to aircraft, destroy projectile
+	// What is left was spawned after the saved tick
+	mDetached.clear();
 
-			aircraft.damage(projectile.getDamage());
-			projectile.destroy();
+	mIdentifiers.setLast(state.lastIdentifier);
+	mSceneGraph.updateWorldTransforms();
+}
 
-			//AAAA
-		}
+void World::setResimulating(bool resimulating)
+{
+	mIsResimulating = resimulating;
+
+	for (ParticleNode* node : mParticleNodes)
+		node->setPaused(resimulating);
+}
+
+bool World::isResimulating() const
+{
+	return mIsResimulating;
+}
+
+void World::collectEntities()
+{
+	Command collector;
+	collector.category = static_cast<int>(CategoryID::Aircraft) | static_cast<int>(CategoryID::Projectile) | static_cast<int>(CategoryID::Pickup);
+	collector.action = derivedAction<Entity>([this](Entity& entity, sf::Time)
+	{
+		mEntities.push_back(&entity);
+	});
+
+	mEntities.clear();
+	mCategoryRegistry.dispatch(collector, sf::Time::Zero);
+}
+
+SceneNode::Ptr World::takeDetached(unsigned int identifier)
+{
+	auto found = std::lower_bound(mDetached.begin(), mDetached.end(), identifier, [](const auto& entry, unsigned int id)
+	{
+		return entry.first < id;
+	});
+
+	if (found == mDetached.end() || found->first != identifier)
+		return nullptr;
+
+	return std::move(found->second);
+}
+
+void World::collectAircraft()
+{
+	Command collector;
+	collector.category = static_cast<int>(CategoryID::Aircraft);
+	collector.action = derivedAction<Aircraft>([this](Aircraft& aircraft, sf::Time)
+	{
+		mAircraft.push_back(&aircraft);
+	});
+
+	mAircraft.clear();
+	mCategoryRegistry.dispatch(collector, sf::Time::Zero);
+}
+
+std::size_t World::getParticleUploadBytes() const
+{
+	//Vertex bytes the particle nodes sent to the driver during the last draw
+	std::size_t bytes = 0;
+	for (const ParticleNode* node : mParticleNodes)
+		bytes += node->getUploadedBytes();
+
+	return bytes;
+}
+
+void World::loadTextures()
+{
+	// Batched sprite textures are packed; the tiled background, explosion sheet and particle draw their own texture
+	loadTexture(TextureID::Entities, "Media/Textures/Entities.png", true);
+	loadTexture(TextureID::Enemy, "Media/Textures/Enemy.png", true);
+	loadTexture(TextureID::TitleScreen, "Media/Textures/TitleScreen.png");
+	loadTexture(TextureID::Player, "Media/Textures/Player.png", true);
+	loadTexture(TextureID::Player2, "Media/Textures/Player2.png", true);
+	loadTexture(TextureID::Explosion, "Media/Textures/Explosion.png");
+	loadTexture(TextureID::Particle, "Media/Textures/Particle.png");
+	loadTexture(TextureID::FinishLine, "Media/Textures/FinishLine.png", true);
+
+	if (!isHeadless())
+	{
+		mTextureAtlas.build();
+		mSpriteBatch.setAtlas(&mTextureAtlas);
 	}
 }
 
+void World::loadTexture(TextureID id, const std::string& filename, bool packed)
+{
+	// Headless worlds never draw, so an empty texture stands in without reading or uploading the image
+	if (isHeadless())
+	{
+		mTextures.loadEmpty(id);
+		return;
+	}
+
+	if (!packed)
+	{
+		mTextures.load(id, filename);
+		return;
+	}
+
+	// Packed textures are decoded once into the atlas; the holder keeps an empty texture as the sprites' key, so no copy stays uploaded
+	sf::Image image;
+	if (!image.loadFromFile(filename))
+		throw std::runtime_error("World::loadTexture - Failed to load " + filename);
+
+	mTextures.loadEmpty(id);
+	mTextureAtlas.add(mTextures.get(id), image);
+}
+
+void World::setupCollisionResponses()
+{
+	// Only these category pairs have a response; every other overlap is rejected during pair generation
+	auto aircraftCollision = [](const CollisionMatrix::Contact& contact)
+	{
+		auto& player = static_cast<Aircraft&>(*contact.first.node);
+		auto& enemy = static_cast<Aircraft&>(*contact.second.node);
+
+		// Collision: Player damage = enemy's remaining HP
+		player.damage(enemy.getHitpoints());
+		enemy.destroy();
+	};
+
+	auto pickupCollision = [this](const CollisionMatrix::Contact& contact)
+	{
+		auto& player = static_cast<Aircraft&>(*contact.first.node);
+		auto& pickup = static_cast<Pickup&>(*contact.second.node);
+
+		// Apply pickup effect to player, destroy pickup
+		pickup.apply(player);
+		player.playerLocalSound(mCommandQueue, SoundEffectID::CollectPickup);
+		pickup.destroy();
+	};
+
+	auto projectileCollision = [](const CollisionMatrix::Contact& contact)
+	{
+		auto& aircraft = static_cast<Aircraft&>(*contact.first.node);
+		auto& projectile = static_cast<Projectile&>(*contact.second.node);
+
+		// Apply projectile damage to aircraft, destroy projectile
+		aircraft.damage(projectile.getDamage());
+		projectile.destroy();
+	};
+
+	auto bulletCollision = [](const CollisionMatrix::Contact& contact)
+	{
+		auto& aircraft = static_cast<Aircraft&>(*contact.first.node);
+		auto& bullets = static_cast<BulletSystem&>(*contact.second.node);
+
+		// Same as a projectile hit, but the bullet is an element of the bullet system
+		aircraft.damage(bullets.getDamage(contact.second.index));
+		bullets.destroy(contact.second.index);
+	};
+
+	mCollisionMatrix.add(CategoryID::PlayerAircraft, CategoryID::EnemyAircraft, aircraftCollision);
+	mCollisionMatrix.add(CategoryID::Player2Aircraft, CategoryID::EnemyAircraft, aircraftCollision);
+	mCollisionMatrix.add(CategoryID::PlayerAircraft, CategoryID::Pickup, pickupCollision);
+	mCollisionMatrix.add(CategoryID::Player2Aircraft, CategoryID::Pickup, pickupCollision);
+	mCollisionMatrix.add(CategoryID::EnemyAircraft, CategoryID::AlliedProjectile, projectileCollision);
+	mCollisionMatrix.add(CategoryID::PlayerAircraft, CategoryID::EnemyProjectile, projectileCollision);
+	mCollisionMatrix.add(CategoryID::Player2Aircraft, CategoryID::EnemyProjectile, projectileCollision);
+	mCollisionMatrix.add(CategoryID::EnemyAircraft, CategoryID::AlliedBullet, bulletCollision);
+	mCollisionMatrix.add(CategoryID::PlayerAircraft, CategoryID::EnemyBullet, bulletCollision);
+	mCollisionMatrix.add(CategoryID::Player2Aircraft, CategoryID::EnemyBullet, bulletCollision);
+}
+
+void World::handleCollisions()
+{
+	// Rebuild the broadphase from the collidable entities, then only test interacting pairs sharing a cell
+	// With worker threads the cells are tested in parallel; contacts come out in the same order either way
+	mCollisionGrid.clear();
+	mSceneGraph.collectColliders(mCollisionGrid);
+
+	mCollisionContacts.clear();
+	if (mJobSystem)
+		mCollisionGrid.findContacts(mCollisionMatrix, mCollisionContacts, *mJobSystem, mChunkContacts);
+	else
+		mCollisionGrid.findContacts(mCollisionMatrix, mCollisionContacts);
+
+	// Responses stay on this thread; they change entities that other contacts refer to
+	for (const CollisionMatrix::Contact& contact : mCollisionContacts)
+		mCollisionMatrix.respond(contact);
+}
+
 void World::buildScene()
 {
 	// Initialize the different layers
@@ -238,31 +873,44 @@ void World::buildScene()
 	mSceneLayers[static_cast<int>(LayerID::Background)]->attachChild(std::move(backgroundSprite));
 
 	//Add the finish line to the scene
+	// The finish line texture is only an atlas key, so its size comes from the atlas; headless worlds get an empty rect
 	sf::Texture& finishTexture = mTextures.get(TextureID::FinishLine);
-	std::unique_ptr<SpriteNode> finishSprite(new SpriteNode(finishTexture));
+	const TextureAtlas::Region* finishRegion = mTextureAtlas.find(&finishTexture);
+	sf::Vector2i finishSize = finishRegion ? sf::Vector2i(finishRegion->size) : sf::Vector2i();
+	std::unique_ptr<SpriteNode> finishSprite(new SpriteNode(finishTexture, sf::IntRect(sf::Vector2i(), finishSize)));
 	finishSprite->setPosition(0.f, -76.f);
 	mSceneLayers[static_cast<int>(LayerID::Background)]->attachChild(std::move(finishSprite));
 
-	//Add particle nodes for smoke and propellant
-	std::unique_ptr<ParticleNode> smokeNode(new ParticleNode(ParticleID::Smoke, mTextures));
+	//Add particle nodes for smoke and propellant, streaming their quads to the GPU where supported
+	std::unique_ptr<ParticleNode> smokeNode(new ParticleNode(ParticleID::Smoke, mTextures, !isHeadless()));
+	mParticleNodes.push_back(smokeNode.get());
 	mSceneLayers[static_cast<int>(LayerID::LowerAir)]->attachChild(std::move(smokeNode));
 
-	std::unique_ptr<ParticleNode> propellantNode(new ParticleNode(ParticleID::Propellant, mTextures));
+	std::unique_ptr<ParticleNode> propellantNode(new ParticleNode(ParticleID::Propellant, mTextures, !isHeadless()));
+	mParticleNodes.push_back(propellantNode.get());
 	mSceneLayers[static_cast<int>(LayerID::LowerAir)]->attachChild(std::move(propellantNode));
 
-	//Add the sound effect node
-	std::unique_ptr<SoundNode> soundNode(new SoundNode(mSounds));
-	mSceneGraph.attachChild(std::move(soundNode));
+	//Add the bullet system, which owns every unguided bullet
+	std::unique_ptr<BulletSystem> bulletSystem(new BulletSystem(mTextures, mIdentifiers));
+	mBulletSystem = bulletSystem.get();
+	mSceneLayers[static_cast<int>(LayerID::LowerAir)]->attachChild(std::move(bulletSystem));
+
+	//Add the sound effect node; without one, sound commands find no receiver and are dropped
+	if (mSounds)
+	{
+		std::unique_ptr<SoundNode> soundNode(new SoundNode(*mSounds));
+		mSceneGraph.attachChild(std::move(soundNode));
+	}
 
 	// Add player's aircraft
-	std::unique_ptr<Aircraft> player(new Aircraft(AircraftID::Player, mTextures, mFonts));
+	std::unique_ptr<Aircraft> player(new Aircraft(AircraftID::Player, mTextures, mFonts, mProjectilePool, mIdentifiers));
 	mPlayerAircraft = player.get();
 	mPlayerAircraft->setPosition(mSpawnPosition + sf::Vector2f(-50, -50));
 	mPlayerAircraft->setRotation(90);
 	mPlayerAircraft->setScale(0.8f, 0.8f);
 	mSceneLayers[static_cast<int>(LayerID::UpperAir)]->attachChild(std::move(player));
 
-	std::unique_ptr<Aircraft> player2(new Aircraft(AircraftID::Player2, mTextures, mFonts));
+	std::unique_ptr<Aircraft> player2(new Aircraft(AircraftID::Player2, mTextures, mFonts, mProjectilePool, mIdentifiers));
 	mPlayer2Aircraft = player2.get();
 	mPlayer2Aircraft->setPosition(mSpawnPosition2 + sf::Vector2f(50, 50));
 	mPlayer2Aircraft->setRotation(90);
@@ -270,6 +918,7 @@ void World::buildScene()
 	mSceneLayers[static_cast<int>(LayerID::UpperAir)]->attachChild(std::move(player2));
 
 	addEnemies();
+	mSpawnCursor = mEnemySpawnPoints.size();
 }
 
 void World::adaptPlayerPosition()
@@ -370,12 +1019,12 @@ void World::addEnemy(AircraftID type, float relX, float relY)
 void World::spawnEnemies()
 {
 	// Spawn all enemies entering the view area (including distance) this frame
-	while (!mEnemySpawnPoints.empty()
-		&& mEnemySpawnPoints.back().y > getBattlefieldBounds().top)
+	while (mSpawnCursor > 0
+		&& mEnemySpawnPoints[mSpawnCursor - 1].y > getBattlefieldBounds().top)
 	{
-		SpawnPoint spawn = mEnemySpawnPoints.back();
+		SpawnPoint spawn = mEnemySpawnPoints[mSpawnCursor - 1];
 
-		std::unique_ptr<Aircraft> enemy(new Aircraft(spawn.type, mTextures, mFonts));
+		std::unique_ptr<Aircraft> enemy(new Aircraft(spawn.type, mTextures, mFonts, mProjectilePool, mIdentifiers));
 		enemy->setPosition(spawn.x, spawn.y);
 		enemy->setRotation(270.f);
 		enemy->setVelocity(-mScrollSpeed, 0.f);
@@ -383,8 +1032,8 @@ void World::spawnEnemies()
 
 		mSceneLayers[static_cast<int>(LayerID::UpperAir)]->attachChild(std::move(enemy));
 
-		// Enemy is spawned, remove from the list to spawn
-		mEnemySpawnPoints.pop_back();
+		// Enemy is spawned; the point stays in the list, so restoring an earlier state can move the cursor back
+		--mSpawnCursor;
 	}
 }
 
@@ -398,7 +1047,15 @@ void World::destroyEntitiesOutsideView()
 			e.destroy();
 	});
 
-	mCommandQueue.push(command);
+	Command bulletCommand;
+	bulletCommand.category = static_cast<int>(CategoryID::BulletSystem);
+	bulletCommand.action = derivedAction<BulletSystem>([this](BulletSystem& bullets, sf::Time)
+	{
+		bullets.destroyOutside(getBattlefieldBounds());
+	});
+
+	mCommandQueue.push(std::move(command));
+	mCommandQueue.push(std::move(bulletCommand));
 }
 
 void World::guideMissiles()
@@ -441,8 +1098,8 @@ void World::guideMissiles()
 	});
 
 	// Push commands, reset active enemies
-	mCommandQueue.push(enemyCollector);
-	mCommandQueue.push(missileGuider);
+	mCommandQueue.push(std::move(enemyCollector));
+	mCommandQueue.push(std::move(missileGuider));
 	mActiveEnemies.clear();
 }
 
@@ -13,12 +13,27 @@
 #include "BloomEffect.hpp"
 #include "SoundNode.hpp"
 #include "SoundPlayer.hpp"
+#include "CollisionMatrix.hpp"
+#include "CollisionGrid.hpp"
+#include "CategoryRegistry.hpp"
+#include "ProjectilePool.hpp"
+#include "ParticleNode.hpp"
+#include "Profiler.hpp"
+#include "SpriteBatch.hpp"
+#include "TextureAtlas.hpp"
+#include "IdentifierSequence.hpp"
+#include "RenderThread.hpp"
+#include "JobSystem.hpp"
+#include "WorldSnapshot.hpp"
+#include "WorldState.hpp"
 
 #include "SFML/System/NonCopyable.hpp"
 #include "SFML/Graphics/View.hpp"
 #include "SFML/Graphics/Texture.hpp"
 
 #include <array>
+#include <memory>
+#include <string>
 
 
 //Forward declaration
@@ -32,34 +47,75 @@ class World : private sf::NonCopyable
 {
 public:
 	explicit World(sf::RenderTarget& outputTarget, FontHolder& fonts, SoundPlayer& sounds);
+	//Headless world: no window, audio or textures, but the same update pipeline
+	explicit World(sf::Vector2f viewSize);
 	void update(sf::Time dt);
-	void draw();
+	//alpha is how far the picture is from the state before the last tick (0) to the one after it (1)
+	void draw(float alpha = 1.f);
 	CommandQueue& getCommandQueue();
 	bool hasAlivePlayer() const;
 	bool hasPlayerReachedEnd() const;
 	bool hasAlivePlayer2() const;
 	bool hasPlayer2ReachedEnd() const;
 	void updateSounds();
+	std::size_t getParticleUploadBytes() const;
+	bool isHeadless() const;
+	void setProfiler(Profiler* profiler);
+	//Draw on a render thread from a copy of each frame; the target shows every frame one frame late
+	void setRenderThread(bool enabled);
+	bool hasRenderThread() const;
+	//Update the entities on this many worker threads besides the calling one; 0 updates them all on the calling thread
+	//Commands, and so the outcome of every tick, are the same for any count
+	void setWorkerThreads(std::size_t count);
+	std::size_t getWorkerThreads() const;
+
+	//A replica (network client) takes enemies, damage and deaths from server snapshots instead of simulating them
+	void setReplica(bool replica);
+	bool isReplica() const;
+	void captureSnapshot(WorldSnapshot& snapshot);
+	//The predicted aircraft keeps its own position; the others are moved ahead by latency
+	void applySnapshot(const WorldSnapshot& snapshot, unsigned int predictedIdentifier, sf::Time latency);
+	Aircraft* getAircraft(unsigned int identifier);
+	//View bounds plus the strip above where enemies spawn; nothing outside lives long
+	sf::FloatRect getBattlefieldBounds() const;
+
+	//Rollback: save between ticks, restore to go back, then update through the ticks again
+	void saveState(WorldState& state);
+	void restoreState(const WorldState& state);
+	//While resimulating, update() keeps sounds and particles as they are; those ticks were already heard and seen
+	void setResimulating(bool resimulating);
+	bool isResimulating() const;
 
 private:
+	World(sf::RenderTarget* outputTarget, FontHolder* fonts, SoundPlayer* sounds, const sf::View& camera);
+
 	void loadTextures();
+	void loadTexture(TextureID id, const std::string& filename, bool packed = false);
 	void buildScene();
 	void adaptPlayerPosition();
 	void adaptPlayerVelocity();
 	void adaptPlayer2Position();
 	void adaptPlayer2Velocity();
+	void setupCollisionResponses();
 	void handleCollisions();
+	void dispatchCommands(sf::Time dt);
 
 	void spawnEnemies();
 	void addEnemies();
 	void addEnemy(AircraftID type, float relX, float relY);
 
-	sf::FloatRect getBattlefieldBounds() const;
 	sf::FloatRect getViewBounds() const;
 
 	void destroyEntitiesOutsideView();
 
 	void guideMissiles();
+	void collectAircraft();
+	void collectEntities();
+	SceneNode::Ptr takeDetached(unsigned int identifier);
+	sf::View getInterpolatedCamera(float alpha) const;
+	void beginBatch(float alpha);
+	void drawScene(sf::RenderTarget& target, const sf::View& camera, float alpha);
+	void recordScene(RenderFrame& frame, const sf::View& camera, float alpha);
 
 	struct SpawnPoint
 	{
@@ -76,16 +132,26 @@ private:
 	};
 
 private:
-	sf::RenderTarget& mTarget;
+	// Null in a headless world
+	sf::RenderTarget* mTarget;
 	sf::RenderTexture mSceneTexture;
 	sf::View mCamera;
+	sf::Vector2f mPreviousCameraCenter;
 	TextureHolder mTextures;
-	FontHolder& mFonts;
-	SoundPlayer& mSounds;
-
+	TextureAtlas mTextureAtlas;
+	FontHolder* mFonts;
+	SoundPlayer* mSounds;
+
+	// Declared before the scene graph, so pooled projectiles are destroyed before their storage
+	ProjectilePool mProjectilePool;
+	IdentifierSequence mIdentifiers;
+	CategoryRegistry mCategoryRegistry;
 	SceneNode mSceneGraph;
 	std::array<SceneNode*, static_cast<int>(LayerID::LayerCount)> mSceneLayers;
 	CommandQueue mCommandQueue;
+	// Null without worker threads; a command queue per chunk of entities
+	std::unique_ptr<JobSystem> mJobSystem;
+	std::vector<CommandQueue> mChunkQueues;
 
 	sf::FloatRect mWorldBounds;
 	sf::Vector2f mSpawnPosition;
@@ -94,8 +160,29 @@ private:
 	Aircraft* mPlayerAircraft;
 	Aircraft* mPlayer2Aircraft;
 
+	// Points below the cursor are still to spawn, sorted so the next one is just below it
 	std::vector<SpawnPoint>	mEnemySpawnPoints;
+	std::size_t mSpawnCursor;
 	std::vector<Aircraft*> mActiveEnemies;
-
-	BloomEffect	mBloomEffect;
+	std::vector<Aircraft*> mAircraft;
+	bool mIsReplica;
+	bool mIsResimulating;
+	std::vector<ParticleNode*> mParticleNodes;
+	BulletSystem* mBulletSystem;
+
+	// Scratch storage of restoreState
+	std::vector<Entity*> mEntities;
+	std::vector<std::pair<unsigned int, SceneNode::Ptr>> mDetached;
+
+	CollisionMatrix mCollisionMatrix;
+	CollisionGrid mCollisionGrid;
+	std::vector<CollisionMatrix::Contact> mCollisionContacts;
+	// A contact list per chunk of cells, used with worker threads
+	std::vector<std::vector<CollisionMatrix::Contact>> mChunkContacts;
+
+	SpriteBatch mSpriteBatch;
+	std::unique_ptr<BloomEffect> mBloomEffect;
+	// Declared after the textures and fonts its frames point to, so it stops before they go
+	std::unique_ptr<RenderThread> mRenderThread;
+	Profiler* mProfiler;
 };
\ No newline at end of file
@@ -0,0 +1,409 @@
+#include "WorldSnapshot.hpp"
+#include "NetworkProtocol.hpp"
+#include "BitStream.hpp"
+
+#include <SFML/Network/Packet.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Bit 0 of every field mask; a created entity writes its type and all fields against a zeroed entry
+	const sf::Uint32 Created = 1 << 0;
+
+	enum AircraftField
+	{
+		AircraftPosition = 1 << 1,
+		AircraftVelocity = 1 << 2,
+		AircraftHitpoints = 1 << 3,
+		AircraftWeapons = 1 << 4,
+		AircraftFieldBits = 5
+	};
+
+	enum ProjectileField
+	{
+		ProjectilePosition = 1 << 1,
+		ProjectileVelocity = 1 << 2,
+		ProjectileFieldBits = 3
+	};
+
+	enum PickupField
+	{
+		PickupPosition = 1 << 1,
+		PickupFieldBits = 2
+	};
+
+	sf::Int32 toFixed(float value)
+	{
+		return static_cast<sf::Int32>(std::lround(value / SnapshotPrecision));
+	}
+
+	// Vectors are written as the difference of their fixed-point values, which is small for a delta and exact either way
+	void writeVector(BitWriter& writer, sf::Vector2f value, sf::Vector2f reference)
+	{
+		writer.writeCompactSigned(toFixed(value.x) - toFixed(reference.x));
+		writer.writeCompactSigned(toFixed(value.y) - toFixed(reference.y));
+	}
+
+	void readVector(BitReader& reader, sf::Vector2f& value)
+	{
+		value.x = (toFixed(value.x) + reader.readCompactSigned()) * SnapshotPrecision;
+		value.y = (toFixed(value.y) + reader.readCompactSigned()) * SnapshotPrecision;
+	}
+
+	// Aircraft
+	unsigned int fieldBits(const AircraftSnapshot&)
+	{
+		return AircraftFieldBits;
+	}
+
+	sf::Uint32 changedFields(const AircraftSnapshot& current, const AircraftSnapshot& previous)
+	{
+		sf::Uint32 fields = 0;
+		if (current.position != previous.position)
+			fields |= AircraftPosition;
+		if (current.velocity != previous.velocity)
+			fields |= AircraftVelocity;
+		if (current.hitpoints != previous.hitpoints)
+			fields |= AircraftHitpoints;
+		if (current.fireRateLevel != previous.fireRateLevel || current.spreadLevel != previous.spreadLevel || current.missileAmmo != previous.missileAmmo)
+			fields |= AircraftWeapons;
+
+		return fields;
+	}
+
+	void writeFields(BitWriter& writer, const AircraftSnapshot& current, const AircraftSnapshot& reference, sf::Uint32 fields)
+	{
+		if (fields & Created)
+			writer.write(static_cast<sf::Uint32>(current.type), 2);
+		if (fields & AircraftPosition)
+			writeVector(writer, current.position, reference.position);
+		if (fields & AircraftVelocity)
+			writeVector(writer, current.velocity, reference.velocity);
+		if (fields & AircraftHitpoints)
+			writer.writeCompactSigned(current.hitpoints - reference.hitpoints);
+		if (fields & AircraftWeapons)
+		{
+			writer.write(current.fireRateLevel, 4);
+			writer.write(current.spreadLevel, 2);
+			writer.writeCompact(current.missileAmmo);
+		}
+	}
+
+	void readFields(BitReader& reader, AircraftSnapshot& aircraft, sf::Uint32 fields)
+	{
+		if (fields & Created)
+			aircraft.type = static_cast<AircraftID>(reader.read(2));
+		if (fields & AircraftPosition)
+			readVector(reader, aircraft.position);
+		if (fields & AircraftVelocity)
+			readVector(reader, aircraft.velocity);
+		if (fields & AircraftHitpoints)
+			aircraft.hitpoints += reader.readCompactSigned();
+		if (fields & AircraftWeapons)
+		{
+			aircraft.fireRateLevel = reader.read(4);
+			aircraft.spreadLevel = reader.read(2);
+			aircraft.missileAmmo = reader.readCompact();
+		}
+	}
+
+	// Projectiles
+	unsigned int fieldBits(const ProjectileSnapshot&)
+	{
+		return ProjectileFieldBits;
+	}
+
+	sf::Uint32 changedFields(const ProjectileSnapshot& current, const ProjectileSnapshot& previous)
+	{
+		sf::Uint32 fields = 0;
+		if (current.position != previous.position)
+			fields |= ProjectilePosition;
+		if (current.velocity != previous.velocity)
+			fields |= ProjectileVelocity;
+
+		return fields;
+	}
+
+	void writeFields(BitWriter& writer, const ProjectileSnapshot& current, const ProjectileSnapshot& reference, sf::Uint32 fields)
+	{
+		if (fields & Created)
+			writer.write(static_cast<sf::Uint32>(current.type), 2);
+		if (fields & ProjectilePosition)
+			writeVector(writer, current.position, reference.position);
+		if (fields & ProjectileVelocity)
+			writeVector(writer, current.velocity, reference.velocity);
+	}
+
+	void readFields(BitReader& reader, ProjectileSnapshot& projectile, sf::Uint32 fields)
+	{
+		if (fields & Created)
+			projectile.type = static_cast<ProjectileID>(reader.read(2));
+		if (fields & ProjectilePosition)
+			readVector(reader, projectile.position);
+		if (fields & ProjectileVelocity)
+			readVector(reader, projectile.velocity);
+	}
+
+	// Pickups
+	unsigned int fieldBits(const PickupSnapshot&)
+	{
+		return PickupFieldBits;
+	}
+
+	sf::Uint32 changedFields(const PickupSnapshot& current, const PickupSnapshot& previous)
+	{
+		return current.position != previous.position ? PickupPosition : 0;
+	}
+
+	void writeFields(BitWriter& writer, const PickupSnapshot& current, const PickupSnapshot& reference, sf::Uint32 fields)
+	{
+		if (fields & Created)
+			writer.write(static_cast<sf::Uint32>(current.type), 2);
+		if (fields & PickupPosition)
+			writeVector(writer, current.position, reference.position);
+	}
+
+	void readFields(BitReader& reader, PickupSnapshot& pickup, sf::Uint32 fields)
+	{
+		if (fields & Created)
+			pickup.type = static_cast<PickupID>(reader.read(2));
+		if (fields & PickupPosition)
+			readVector(reader, pickup.position);
+	}
+
+	template <typename Entry>
+	Entry makeEntry(unsigned int identifier)
+	{
+		Entry entry = Entry();
+		entry.identifier = identifier;
+		return entry;
+	}
+
+	// Writes nothing and returns false for an entry equal to its previous state; a missing previous means created
+	template <typename Entry>
+	bool writeEntry(BitWriter& writer, const Entry& entry, const Entry* previous, unsigned int lastIdentifier)
+	{
+		bool existed = previous && previous->type == entry.type;
+		const Entry reference = existed ? *previous : makeEntry<Entry>(entry.identifier);
+		sf::Uint32 fields = existed ? changedFields(entry, reference) : (1u << fieldBits(entry)) - 1;
+		if (fields == 0)
+			return false;
+
+		writer.writeCompact(entry.identifier - lastIdentifier);
+		writer.write(fields, fieldBits(entry));
+		writeFields(writer, entry, reference, fields);
+		return true;
+	}
+
+	template <typename Entry>
+	std::size_t measureEntry(const Entry& entry, const Entry* previous)
+	{
+		// Assumes the identifier gap of a dense list; the writer only counts, so nothing is allocated per entry
+		BitWriter writer;
+		writeEntry(writer, entry, previous, entry.identifier - 1);
+		return writer.getBitCount();
+	}
+
+	// A list is written as the changed entries, then the removed identifiers; both walk the sorted lists in step,
+	// so identifiers go out as the gap to the previous one
+	template <typename Entry>
+	void encodeList(BitWriter& writer, const std::vector<Entry>& current, const std::vector<Entry>* baseline)
+	{
+		static const std::vector<Entry> Empty;
+		const std::vector<Entry>& previous = baseline ? *baseline : Empty;
+
+		auto findPrevious = [&](std::size_t& p, const Entry& entry) -> const Entry*
+		{
+			while (p < previous.size() && previous[p].identifier < entry.identifier)
+				++p;
+
+			return p < previous.size() && previous[p].identifier == entry.identifier ? &previous[p] : nullptr;
+		};
+
+		// The count goes in front of the entries, so they are counted in a first pass
+		std::size_t changed = 0;
+		std::size_t p = 0;
+		for (const Entry& entry : current)
+		{
+			const Entry* before = findPrevious(p, entry);
+			if (!before || before->type != entry.type || changedFields(entry, *before) != 0)
+				++changed;
+		}
+
+		writer.writeCompact(static_cast<sf::Uint32>(changed));
+
+		unsigned int lastIdentifier = 0;
+		p = 0;
+		for (const Entry& entry : current)
+		{
+			if (writeEntry(writer, entry, findPrevious(p, entry), lastIdentifier))
+				lastIdentifier = entry.identifier;
+		}
+
+		std::size_t removed = 0;
+		for (const Entry& entry : previous)
+		{
+			auto found = std::lower_bound(current.begin(), current.end(), entry.identifier,
+				[](const Entry& e, unsigned int identifier) { return e.identifier < identifier; });
+			if (found == current.end() || found->identifier != entry.identifier)
+				++removed;
+		}
+
+		writer.writeCompact(static_cast<sf::Uint32>(removed));
+
+		lastIdentifier = 0;
+		for (const Entry& entry : previous)
+		{
+			auto found = std::lower_bound(current.begin(), current.end(), entry.identifier,
+				[](const Entry& e, unsigned int identifier) { return e.identifier < identifier; });
+			if (found != current.end() && found->identifier == entry.identifier)
+				continue;
+
+			writer.writeCompact(entry.identifier - lastIdentifier);
+			lastIdentifier = entry.identifier;
+		}
+	}
+
+	template <typename Entry>
+	bool decodeList(BitReader& reader, std::vector<Entry>& entries)
+	{
+		auto lowerBound = [&](unsigned int identifier)
+		{
+			return std::lower_bound(entries.begin(), entries.end(), identifier,
+				[](const Entry& e, unsigned int id) { return e.identifier < id; });
+		};
+
+		sf::Uint32 changed = reader.readCompact();
+		unsigned int identifier = 0;
+		for (sf::Uint32 i = 0; i < changed && reader.isValid(); ++i)
+		{
+			identifier += reader.readCompact();
+			sf::Uint32 fields = reader.read(fieldBits(Entry()));
+
+			// A created entity replaces whatever had its identifier, e.g. in a baseline the sender no longer has
+			auto found = lowerBound(identifier);
+			if (found == entries.end() || found->identifier != identifier)
+				found = entries.insert(found, makeEntry<Entry>(identifier));
+			else if (fields & Created)
+				*found = makeEntry<Entry>(identifier);
+
+			readFields(reader, *found, fields);
+		}
+
+		sf::Uint32 removed = reader.readCompact();
+		identifier = 0;
+		for (sf::Uint32 i = 0; i < removed && reader.isValid(); ++i)
+		{
+			identifier += reader.readCompact();
+
+			auto found = lowerBound(identifier);
+			if (found != entries.end() && found->identifier == identifier)
+				entries.erase(found);
+		}
+
+		return reader.isValid();
+	}
+}
+
+sf::Vector2f quantizeVector(sf::Vector2f vector)
+{
+	return sf::Vector2f(toFixed(vector.x) * SnapshotPrecision, toFixed(vector.y) * SnapshotPrecision);
+}
+
+std::size_t measureSnapshotEntry(const AircraftSnapshot& aircraft, const AircraftSnapshot* previous)
+{
+	return measureEntry(aircraft, previous);
+}
+
+std::size_t measureSnapshotEntry(const ProjectileSnapshot& projectile, const ProjectileSnapshot* previous)
+{
+	return measureEntry(projectile, previous);
+}
+
+std::size_t measureSnapshotEntry(const PickupSnapshot& pickup, const PickupSnapshot* previous)
+{
+	return measureEntry(pickup, previous);
+}
+
+WorldSnapshot::WorldSnapshot()
+	: tick(0)
+	, spawnCursor(0)
+	, aircraft()
+	, projectiles()
+	, pickups()
+{
+}
+
+const AircraftSnapshot* findAircraft(const WorldSnapshot& snapshot, unsigned int identifier)
+{
+	auto found = std::lower_bound(snapshot.aircraft.begin(), snapshot.aircraft.end(), identifier,
+		[](const AircraftSnapshot& aircraft, unsigned int id) { return aircraft.identifier < id; });
+
+	if (found == snapshot.aircraft.end() || found->identifier != identifier)
+		return nullptr;
+
+	return &*found;
+}
+
+void encodeSnapshot(std::vector<sf::Uint8>& buffer, const WorldSnapshot& snapshot, const WorldSnapshot* baseline)
+{
+	BitWriter writer(buffer);
+	writer.write(snapshot.tick, 32);
+	writer.write(baseline ? baseline->tick : NoSnapshot, 32);
+	writer.writeCompact(snapshot.spawnCursor);
+
+	encodeList(writer, snapshot.aircraft, baseline ? &baseline->aircraft : nullptr);
+	encodeList(writer, snapshot.projectiles, baseline ? &baseline->projectiles : nullptr);
+	encodeList(writer, snapshot.pickups, baseline ? &baseline->pickups : nullptr);
+}
+
+bool decodeSnapshot(const sf::Uint8* data, std::size_t size, WorldSnapshot& snapshot, const std::deque<WorldSnapshot>& history)
+{
+	BitReader reader(data, size);
+	sf::Uint32 tick = reader.read(32);
+	sf::Uint32 baselineTick = reader.read(32);
+	if (!reader.isValid())
+		return false;
+
+	// A baseline we no longer have makes the delta useless; the sender falls back to a full snapshot once acks catch up
+	if (baselineTick != NoSnapshot)
+	{
+		auto baseline = std::find_if(history.begin(), history.end(), [&](const WorldSnapshot& s) { return s.tick == baselineTick; });
+		if (baseline == history.end())
+			return false;
+
+		snapshot = *baseline;
+	}
+	else
+	{
+		snapshot = WorldSnapshot();
+	}
+
+	snapshot.tick = tick;
+	snapshot.spawnCursor = reader.readCompact();
+
+	return decodeList(reader, snapshot.aircraft)
+		&& decodeList(reader, snapshot.projectiles)
+		&& decodeList(reader, snapshot.pickups);
+}
+
+void writeSnapshot(sf::Packet& packet, const WorldSnapshot& snapshot, const WorldSnapshot* baseline)
+{
+	std::vector<sf::Uint8> buffer;
+	encodeSnapshot(buffer, snapshot, baseline);
+
+	packet << static_cast<sf::Uint32>(buffer.size());
+	packet.append(buffer.data(), buffer.size());
+}
+
+bool readSnapshot(sf::Packet& packet, WorldSnapshot& snapshot, const std::deque<WorldSnapshot>& history)
+{
+	sf::Uint32 size;
+	if (!(packet >> size) || size > packet.getDataSize())
+		return false;
+
+	const sf::Uint8* data = static_cast<const sf::Uint8*>(packet.getData());
+	return decodeSnapshot(data + packet.getDataSize() - size, size, snapshot, history);
+}
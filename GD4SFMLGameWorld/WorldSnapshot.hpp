@@ -0,0 +1,78 @@
+#pragma once
+#include "AircraftID.hpp"
+#include "ProjectileID.hpp"
+#include "PickupID.hpp"
+
+#include <SFML/Config.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <deque>
+#include <vector>
+
+namespace sf
+{
+	class Packet;
+}
+
+//Positions and velocities are captured rounded to this step, so encoding them loses nothing further
+const float SnapshotPrecision = 1.f / 16.f;
+
+sf::Vector2f quantizeVector(sf::Vector2f vector);
+
+struct AircraftSnapshot
+{
+	unsigned int identifier;
+	AircraftID type;
+	sf::Vector2f position;
+	sf::Vector2f velocity;
+	int hitpoints;
+	int fireRateLevel;
+	int spreadLevel;
+	int missileAmmo;
+};
+
+//Missiles and bullets alike; bullets carry identifiers from the same sequence as entities
+struct ProjectileSnapshot
+{
+	unsigned int identifier;
+	ProjectileID type;
+	sf::Vector2f position;
+	sf::Vector2f velocity;
+};
+
+struct PickupSnapshot
+{
+	unsigned int identifier;
+	PickupID type;
+	sf::Vector2f position;
+};
+
+//Replicated state of a World at one tick; every list is sorted by identifier
+struct WorldSnapshot
+{
+	WorldSnapshot();
+
+	sf::Uint32 tick;
+	//Enemy spawn points not yet reached
+	unsigned int spawnCursor;
+	std::vector<AircraftSnapshot> aircraft;
+	std::vector<ProjectileSnapshot> projectiles;
+	std::vector<PickupSnapshot> pickups;
+};
+
+const AircraftSnapshot* findAircraft(const WorldSnapshot& snapshot, unsigned int identifier);
+
+//Bits one entry adds to a delta against its previous state (null: not in the baseline); zero when unchanged
+std::size_t measureSnapshotEntry(const AircraftSnapshot& aircraft, const AircraftSnapshot* previous);
+std::size_t measureSnapshotEntry(const ProjectileSnapshot& projectile, const ProjectileSnapshot* previous);
+std::size_t measureSnapshotEntry(const PickupSnapshot& pickup, const PickupSnapshot* previous);
+
+//Bit-packed; only what changed since baseline (entities added, removed or with a changed field). Null writes everything
+void encodeSnapshot(std::vector<sf::Uint8>& buffer, const WorldSnapshot& snapshot, const WorldSnapshot* baseline);
+
+//Rebuilds a snapshot on top of the baseline it was encoded against, looked up by tick in history
+bool decodeSnapshot(const sf::Uint8* data, std::size_t size, WorldSnapshot& snapshot, const std::deque<WorldSnapshot>& history);
+
+//The encoded snapshot goes last in the packet, after whatever header the caller wrote
+void writeSnapshot(sf::Packet& packet, const WorldSnapshot& snapshot, const WorldSnapshot* baseline);
+bool readSnapshot(sf::Packet& packet, WorldSnapshot& snapshot, const std::deque<WorldSnapshot>& history);
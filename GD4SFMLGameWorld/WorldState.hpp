@@ -0,0 +1,25 @@
+#pragma once
+#include "Aircraft.hpp"
+#include "Projectile.hpp"
+#include "Pickup.hpp"
+#include "BulletSystem.hpp"
+
+#include <SFML/System/Vector2.hpp>
+
+#include <vector>
+
+//Exact simulation state of a World between two ticks, saved and restored for rollback
+//Unlike a WorldSnapshot nothing is rounded, and cosmetic state (particles, sounds, texts) is left out
+//A WorldState that is saved into again reuses its vectors, so a ring of them saves every tick without allocating
+struct WorldState
+{
+	sf::Vector2f cameraCenter;
+	std::size_t spawnCursor;
+	unsigned int lastIdentifier;
+
+	// Sorted by identifier, which is also the order the entities were attached to the scene in
+	std::vector<Aircraft::State> aircraft;
+	std::vector<Projectile::State> projectiles;
+	std::vector<Pickup::State> pickups;
+	BulletSystem::State bullets;
+};